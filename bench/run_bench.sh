@@ -0,0 +1,234 @@
+#!/usr/bin/env bash
+# ============================================================================
+# Scaling benchmark harness (run by `make bench`)
+#
+# Author:  canetizen
+# Created: 2026-10-18
+#
+# Usage:
+#   bench/run_bench.sh [config] [repeat] [mpirun_flags]
+#
+# Runs every sweep of the configuration (default bench/bench.conf) `repeat`
+# times per configuration. Each run's time is read from the standard line
+#   Execution time: <seconds> seconds
+# that the programs print; the run's wall time is used when a program does
+# not print it. The minimum and median times, speedup and efficiency go to
+# bench/results/<commit>.csv and bench/results/<commit>.json. Input files
+# made by setup commands are regenerated once per run, so a changed
+# generator never leaves stale inputs behind.
+# ============================================================================
+
+set -u
+
+conf=${1:-bench/bench.conf}
+repeat=${2:-3}
+mpirun_flags=${3:-}
+out_dir=bench/results
+data_dir=${TMPDIR:-/tmp}/parallel-demos-bench
+
+if [ ! -f "$conf" ]; then
+    echo "Error: configuration file not found: $conf"
+    exit 1
+fi
+if ! [ "$repeat" -ge 1 ] 2>/dev/null; then
+    echo "Error: repeat must be a positive integer."
+    exit 1
+fi
+
+commit=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+if [ -n "$(git status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+    commit="$commit-dirty"
+fi
+date=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+host=$(hostname)
+csv="$out_dir/$commit.csv"
+json="$out_dir/$commit.json"
+mkdir -p "$out_dir" "$data_dir"
+
+echo "commit,date,host,target,scaling,work_exponent,args,size,np,threads,workers,repeats,time_source,time_min,time_median,speedup,efficiency" > "$csv"
+json_rows=""
+generated=""  # Data files written by setup commands during this run, one per line
+
+trim() {
+    sed -e 's/^[[:space:]]*//' -e 's/[[:space:]]*$//' <<< "$1"
+}
+
+# Escapes a string for a JSON string literal (backslashes first, then quotes)
+json_escape() {
+    local s=${1//\\/\\\\}
+    printf '%s' "${s//\"/\\\"}"
+}
+
+# Quotes a CSV field, doubling embedded quotes
+csv_quote() {
+    printf '"%s"' "${1//\"/\"\"}"
+}
+
+# Replaces the {n}, {file}, {np} and {threads} placeholders
+expand() {
+    local s=${1//\{n\}/$2}
+    s=${s//\{file\}/$3}
+    s=${s//\{np\}/$4}
+    printf '%s' "${s//\{threads\}/$5}"
+}
+
+uses_mpi() {
+    grep -q '#include[[:space:]]*[<"]mpi.h[">]' "src/$1.c"
+}
+
+# Runs bin/<target> with the given np and threads; prints its time and the time source, or fails
+run_once() {
+    local target=$1 np=$2 threads=$3 args=$4 output start end
+    start=$(date +%s.%N)
+    if uses_mpi "$target"; then
+        # shellcheck disable=SC2086
+        output=$(OMP_NUM_THREADS=$threads mpirun -np "$np" $mpirun_flags "bin/$target" $args 2>&1 < /dev/null) || return 1
+    else
+        # shellcheck disable=SC2086
+        output=$(OMP_NUM_THREADS=$threads "bin/$target" $args 2>&1 < /dev/null) || return 1
+    fi
+    end=$(date +%s.%N)
+    local time
+    time=$(sed -n 's/^Execution time: \([0-9.eE+-]*\) seconds$/\1/p' <<< "$output" | tail -n 1)
+    if [ -n "$time" ]; then
+        echo "$time program"
+    else
+        awk -v s="$start" -v e="$end" 'BEGIN { printf "%.6f wall\n", e - s }'
+    fi
+}
+
+printf "%-30s %-7s %-22s %-12s %-4s %-7s %-11s %-11s %-8s %s\n" \
+       "target" "scaling" "args" "size" "np" "threads" "min (s)" "median (s)" "speedup" "efficiency"
+
+while IFS='|' read -r target scaling nps threads_list sizes args setup <&3; do
+    target=$(trim "$target")
+    case "$target" in ''|'#'*) continue ;; esac
+    scaling=$(trim "$scaling")
+    args=$(trim "$args")
+    setup=$(trim "${setup:-}")
+    sizes=$(trim "$sizes")
+    # weak:<k> means the work grows as size^k, so the size grows as workers^(1/k)
+    exponent=1
+    if [[ "$scaling" == weak:* ]]; then
+        exponent=${scaling#weak:}
+        scaling=weak
+    fi
+    if [ "$scaling" != "strong" ] && [ "$scaling" != "weak" ]; then
+        echo "Error: unknown scaling '$scaling' for $target (strong, weak or weak:<k>), skipping its sweep."
+        continue
+    fi
+    if ! awk -v k="$exponent" 'BEGIN { exit !(k + 0 > 0) }'; then
+        echo "Error: the work exponent of $target must be positive, skipping its sweep."
+        continue
+    fi
+    if [ -z "$sizes" ] && [ "$scaling" = "weak" ]; then
+        echo "Error: weak scaling of $target needs a size list, skipping its sweep."
+        continue
+    fi
+    # An empty size list means one run per configuration without a size
+    sizes=${sizes:--}
+
+    # The setup runs another program when it starts with "<program>:"
+    setup_target=$target
+    if [[ "$setup" =~ ^([A-Za-z0-9_]+):[[:space:]]*(.*)$ ]] && [ -f "src/${BASH_REMATCH[1]}.c" ]; then
+        setup_target=${BASH_REMATCH[1]}
+        setup=${BASH_REMATCH[2]}
+    fi
+    built=1
+    for t in $target $setup_target; do
+        if [ ! -f "src/$t.c" ]; then
+            echo "Error: src/$t.c not found, skipping the sweep of $target."
+            built=0
+        elif ! make -s build TARGET="$t" > /dev/null; then
+            echo "Error: cannot build $t, skipping the sweep of $target."
+            built=0
+        fi
+    done
+    [ "$built" = 1 ] || continue
+
+    first_np=$(awk '{ print $1 }' <<< "$nps")
+    first_threads=$(awk '{ print $1 }' <<< "$threads_list")
+    base_workers=$((first_np * first_threads))
+
+    for size in $sizes; do
+        base_time=""
+        for np in $nps; do
+            for threads in $threads_list; do
+                workers=$((np * threads))
+                n=$size
+                if [ "$scaling" = "weak" ]; then
+                    n=$(awk -v s="$size" -v w="$workers" -v w0="$base_workers" -v k="$exponent" \
+                        'BEGIN { printf "%d\n", s * (w / w0) ^ (1 / k) + 0.5 }')
+                fi
+                file="$data_dir/${target}_$n.bin"
+                run_args=$(expand "$args" "$n" "$file" "$np" "$threads")
+
+                if [ -n "$setup" ] && ! grep -Fxq -- "$file" <<< "$generated"; then
+                    rm -f "$file"
+                    setup_args=$(expand "$setup" "$n" "$file" "$first_np" "$first_threads")
+                    if ! run_once "$setup_target" "$first_np" "$first_threads" "$setup_args" > /dev/null; then
+                        echo "Error: setup of $target ($setup_target $setup_args) failed."
+                        continue
+                    fi
+                    generated="$generated
+$file"
+                fi
+
+                times=""
+                for ((r = 0; r < repeat; r++)); do
+                    if ! result=$(run_once "$target" "$np" "$threads" "$run_args"); then
+                        times=""
+                        break
+                    fi
+                    read -r t source <<< "$result"
+                    times="$times $t"
+                done
+                if [ -z "$times" ]; then
+                    echo "Error: $target $run_args failed with np=$np threads=$threads."
+                    continue
+                fi
+
+                read -r t_min t_median < <(tr ' ' '\n' <<< "$times" | sed '/^$/d' | sort -g | awk '
+                    { t[NR] = $1 }
+                    END { m = (NR % 2) ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2; printf "%.6f %.6f\n", t[1], m }')
+                if [ -z "$base_time" ]; then
+                    base_time=$t_median
+                fi
+                # Strong: speedup = t(base) / t, efficiency = speedup / (workers / base workers).
+                # Weak: efficiency = t(base) / t, scaled speedup = efficiency * workers / base workers.
+                read -r speedup efficiency < <(awk -v b="$base_time" -v t="$t_median" -v w="$workers" -v w0="$base_workers" -v s="$scaling" '
+                    BEGIN {
+                        if (t <= 0) t = 1e-9
+                        if (s == "strong") { sp = b / t; ef = sp / (w / w0) } else { ef = b / t; sp = ef * w / w0 }
+                        printf "%.3f %.3f\n", sp, ef
+                    }')
+
+                printf "%-30s %-7s %-22s %-12s %-4s %-7s %-11s %-11s %-8s %s\n" \
+                       "$target" "$scaling" "$args" "$n" "$np" "$threads" "$t_min" "$t_median" "$speedup" "$efficiency"
+                echo "$commit,$date,$host,$target,$scaling,$exponent,$(csv_quote "$args"),$n,$np,$threads,$workers,$repeat,$source,$t_min,$t_median,$speedup,$efficiency" >> "$csv"
+                json_size=$n
+                if [ "$n" = "-" ]; then
+                    json_size=null
+                fi
+                row=$(printf '    {"target": "%s", "scaling": "%s", "work_exponent": %s, "args": "%s", "size": %s, "np": %s, "threads": %s, "workers": %s, "repeats": %s, "time_source": "%s", "time_min": %s, "time_median": %s, "speedup": %s, "efficiency": %s}' \
+                      "$target" "$scaling" "$exponent" "$(json_escape "$args")" "$json_size" "$np" "$threads" "$workers" "$repeat" "$source" "$t_min" "$t_median" "$speedup" "$efficiency")
+                json_rows="${json_rows:+$json_rows,
+}$row"
+            done
+        done
+    done
+done 3< "$conf"
+
+cat > "$json" << EOF
+{
+  "commit": "$commit",
+  "date": "$date",
+  "host": "$host",
+  "repeat": $repeat,
+  "results": [
+$json_rows
+  ]
+}
+EOF
+
+echo "Results written to $csv and $json"
@@ -4,24 +4,35 @@
  * Description: Character counter using interprocess communication (IPC) mechanisms.
  */ 
 
+#define _POSIX_C_SOURCE 200809L // For clock_gettime under -std=c99
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
-#define MAX_PROCESSES 8
+#define DEFAULT_PROCESSES 8
+#define MAX_PROCESSES 64
 #define MAX_CHARS 256 // Standard ASCII range
 
+// Monotonic wall-clock time in seconds
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 /**
  * Child process function to count character frequencies in a segment.
  * Writes the local count to the pipe and exits.
  */
-void count_characters(const char *segment, int length, int fd_write) {
-    int local_count[MAX_CHARS] = {0};
+void count_characters(const char *segment, long long length, int fd_write) {
+    long long local_count[MAX_CHARS] = {0};
 
     // Count frequency of each character in the assigned segment
-    for (int i = 0; i < length; i++) {
+    for (long long i = 0; i < length; i++) {
         unsigned char c = segment[i];
         local_count[c]++;
     }
@@ -38,18 +49,39 @@ void count_characters(const char *segment, int length, int fd_write) {
     exit(EXIT_SUCCESS);
 }
 
-int main() {
-    // Sample input string (can be replaced with dynamic input)
-    const char *input = "There are two Mustafa Kemals. One the flesh-and-blood Mustafa Kemal who now stands before you and who will pass away. The other is you, all of you here who will go to the far corners of our land to spread the ideals which must be defended with your lives if necessary. I stand for the nation's dreams, and my life's work is to make them come true.";
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        printf("Usage: %s [num_processes] [copies]\n", argv[0]);
+        return 1;
+    }
+    int num_processes = argc > 1 ? atoi(argv[1]) : DEFAULT_PROCESSES;
+    long long copies = argc > 2 ? atoll(argv[2]) : 1;
+    if (num_processes < 1 || num_processes > MAX_PROCESSES || copies < 1) {
+        printf("Error: num_processes must be between 1 and %d and copies must be a positive integer.\n", MAX_PROCESSES);
+        return 1;
+    }
+
+    // Sample input string, repeated `copies` times to make larger inputs
+    const char *sample = "There are two Mustafa Kemals. One the flesh-and-blood Mustafa Kemal who now stands before you and who will pass away. The other is you, all of you here who will go to the far corners of our land to spread the ideals which must be defended with your lives if necessary. I stand for the nation's dreams, and my life's work is to make them come true.";
     
-    int input_len = strlen(input);
-    int segment_size = input_len / MAX_PROCESSES;
+    long long sample_len = strlen(sample);
+    long long input_len = sample_len * copies;
+    char *input = (char *)malloc(input_len);
+    if (input == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (long long c = 0; c < copies; c++) {
+        memcpy(input + c * sample_len, sample, sample_len);
+    }
+    long long segment_size = input_len / num_processes;
 
     int pipes[MAX_PROCESSES][2];            // Pipes for IPC
-    int final_count[MAX_CHARS] = {0};       // Aggregated results
+    long long final_count[MAX_CHARS] = {0}; // Aggregated results
+    double start_time = wall_time();
 
-    // Create child processes and pipes
-    for (int i = 0; i < MAX_PROCESSES; i++) {
+    // Create child processes and pipes; children read the parent's input without copying it (copy-on-write)
+    for (int i = 0; i < num_processes; i++) {
         if (pipe(pipes[i]) == -1) {
             perror("pipe");
             exit(EXIT_FAILURE);
@@ -64,8 +96,8 @@ int main() {
             close(pipes[i][0]); // Close unused read end
 
             // Determine segment bounds
-            int start = i * segment_size;
-            int length = (i == MAX_PROCESSES - 1) ? input_len - start : segment_size;
+            long long start = i * segment_size;
+            long long length = (i == num_processes - 1) ? input_len - start : segment_size;
 
             // Perform character counting
             count_characters(input + start, length, pipes[i][1]);
@@ -76,13 +108,13 @@ int main() {
     }
 
     // Wait for all child processes to complete
-    for (int i = 0; i < MAX_PROCESSES; i++) {
+    for (int i = 0; i < num_processes; i++) {
         wait(NULL);
     }
 
     // Read and aggregate results from each child
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        int local_count[MAX_CHARS] = {0};
+    for (int i = 0; i < num_processes; i++) {
+        long long local_count[MAX_CHARS] = {0};
 
         ssize_t bytes_read = read(pipes[i][0], local_count, sizeof(local_count));
         if (bytes_read != sizeof(local_count)) {
@@ -99,12 +131,17 @@ int main() {
         }
     }
 
+    double elapsed = wall_time() - start_time;
+
     // Print final character frequencies
     for (int i = 0; i < MAX_CHARS; i++) {
         if (final_count[i] > 0) {
-            printf("Character '%c' (%d) => %d times\n", i, i, final_count[i]);
+            printf("Character '%c' (%d) => %lld times\n", i, i, final_count[i]);
         }
     }
+    printf("Execution time: %.6f seconds\n", elapsed);
+
+    free(input);
 
     return 0;
 }
@@ -14,6 +14,7 @@
 #define TAG_RESULT_LEN   20
 #define TAG_RESULT_DATA  21
 #define TAG_TERMINATE    99
+#define PRINT_LIMIT      4096 // Longer inputs are summarized instead of printed
 
 void remove_spaces(const char* input, char* output) {
     int j = 0;
@@ -61,6 +62,31 @@ char* read_input_file(const char* filename, int* out_len) {
     return buffer;
 }
 
+/**
+ * Writes a deterministic test file of `bytes` bytes: words of 1 to 8
+ * letters separated by spaces, with a newline every 16 words.
+ */
+void generate_input_file(const char* filename, long long bytes) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Cannot open output file");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    unsigned long long state = 12345;
+    long long letters_left = 1, words = 0;
+    for (long long i = 0; i < bytes; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL; // 64-bit LCG
+        if (letters_left > 0) {
+            fputc('a' + (int)((state >> 33) % 26), file);
+            letters_left--;
+        } else {
+            fputc(++words % 16 == 0 ? '\n' : ' ', file);
+            letters_left = 1 + (state >> 61);
+        }
+    }
+    fclose(file);
+}
+
 void worker_process() {
     MPI_Status status;
 
@@ -102,6 +128,7 @@ void farmer_process(const char* filename, int num_procs) {
     int input_len;
     char* input_str = read_input_file(filename, &input_len);
     if (!input_str) return;
+    double start_time = MPI_Wtime();
 
     int base = input_len / (num_procs - 1);
     int rem = input_len % (num_procs - 1);
@@ -151,9 +178,16 @@ void farmer_process(const char* filename, int num_procs) {
         MPI_Send(&dummy, 1, MPI_INT, i, TAG_TERMINATE, MPI_COMM_WORLD);
     }
 
+    double elapsed = MPI_Wtime() - start_time;
+
     // Print result
-    printf("Original string: \"%s\"\n\n", input_str);
-    printf("Cleaned result : \"%s\"\n", final_result);
+    if (input_len <= PRINT_LIMIT) {
+        printf("Original string: \"%s\"\n\n", input_str);
+        printf("Cleaned result : \"%s\"\n", final_result);
+    } else {
+        printf("Cleaned %d of %d bytes (%zu bytes left)\n", input_len - (int)strlen(final_result), input_len, strlen(final_result));
+    }
+    printf("Execution time: %.6f seconds\n", elapsed);
 
     free(input_str);
     free(final_result);
@@ -166,6 +200,21 @@ int main(int argc, char* argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
 
+    // Generator mode: -g <file> <bytes>
+    if (argc == 4 && strcmp(argv[1], "-g") == 0) {
+        if (rank == 0) generate_input_file(argv[2], atoll(argv[3]));
+        MPI_Finalize();
+        return 0;
+    }
+    if (argc != 2 || num_procs < 2) {
+        if (rank == 0) {
+            printf("Usage: %s <input_file> (needs at least 2 processes)\n", argv[0]);
+            printf("       %s -g <file> <bytes>\n", argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
     if (rank == 0) {
         farmer_process(argv[1], num_procs);
     } else {
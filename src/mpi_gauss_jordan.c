@@ -0,0 +1,563 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: Hybrid MPI+OpenMP Gauss-Jordan elimination with a row-cyclic layout, MAXLOC pivoting and a pipelined pivot row broadcast.
+ */
+
+#define _POSIX_C_SOURCE 200809L // For posix_memalign under -std=c99
+
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define ALIGNMENT 64           // Every stored row starts on a cache line (also one AVX-512 vector)
+#define TEST_EVERY 16          // Rows updated by the master thread between two MPI_Test calls
+
+// Header of a system file (same format as omp_gauss_jordan_elimination), followed by A (n x n) and B (n x nrhs)
+typedef struct {
+    long long n;
+    long long nrhs;
+} SystemHeader;
+
+/**
+ * The rows of [A | B] owned by one rank. Global row g lives on rank
+ * g % size as local row g / size, so every rank keeps the same share of the
+ * rows that are still unpivoted. Local rows are padded to ld doubles so
+ * each one starts on an ALIGNMENT boundary.
+ */
+typedef struct {
+    long long n;
+    long long nrhs;
+    long long ld;
+    long long local_rows;
+    double* data;
+    int rank;
+    int size;
+    MPI_Comm comm;
+} DistSystem;
+
+// Per-rank wall time of the solve phases
+typedef struct {
+    double compute;
+    double pivot_search;
+    double broadcast;
+} SolveTimes;
+
+// Pivot candidate for MPI_MAXLOC on MPI_DOUBLE_INT: ties go to the lowest global row
+typedef struct {
+    double value;
+    int row;
+} Pivot;
+
+void* aligned_malloc(size_t bytes) {
+    void* p = NULL;
+    if (posix_memalign(&p, ALIGNMENT, bytes > 0 ? bytes : ALIGNMENT) != 0) {
+        fprintf(stderr, "Error: cannot allocate %zu bytes\n", bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return p;
+}
+
+DistSystem alloc_dist_system(long long n, long long nrhs, MPI_Comm comm) {
+    DistSystem s;
+    long long per_line = ALIGNMENT / sizeof(double);
+    MPI_Comm_rank(comm, &s.rank);
+    MPI_Comm_size(comm, &s.size);
+    s.n = n;
+    s.nrhs = nrhs;
+    s.comm = comm;
+    s.ld = (n + nrhs + per_line - 1) / per_line * per_line;
+    s.local_rows = n / s.size + (s.rank < n % s.size);
+    s.data = (double*)aligned_malloc((size_t)(s.local_rows * s.ld * sizeof(double)));
+
+    // First touch by the threads that later update the rows
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < s.local_rows; i++) memset(s.data + i * s.ld, 0, s.ld * sizeof(double));
+    return s;
+}
+
+static inline double* local_row(const DistSystem* s, long long i) {
+    return s->data + i * s->ld;
+}
+
+static inline long long global_row(const DistSystem* s, long long i) {
+    return i * s->size + s->rank;
+}
+
+// Uniform [-1, 1) value from a SplitMix64 hash of a global element index (same entries as omp_gauss_jordan_elimination -g)
+double random_entry(unsigned long long i) {
+    unsigned long long z = i * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (z >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+// Fills the local rows of the random system: A entry (g, j) is hash g * n + j, B entry (g, c) is n * n + g * nrhs + c
+void generate_rows(DistSystem* s) {
+    long long n = s->n, nrhs = s->nrhs;
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < s->local_rows; i++) {
+        double* row = local_row(s, i);
+        unsigned long long g = (unsigned long long)global_row(s, i);
+        for (long long j = 0; j < n; j++) row[j] = random_entry(g * n + j);
+        for (long long c = 0; c < nrhs; c++) row[n + c] = random_entry((unsigned long long)(n * n) + g * nrhs + c);
+    }
+}
+
+/**
+ * Collective read or write of the local rows of A (part 0) or B (part 1).
+ * The file view selects every size-th row of width doubles starting at the
+ * rank's first row, and the memory type skips the row padding, so one
+ * collective call moves all of a rank's rows.
+ */
+void file_rows(MPI_File fh, DistSystem* s, int part, int write) {
+    long long width = part == 0 ? s->n : s->nrhs;
+    MPI_Offset base = (MPI_Offset)sizeof(SystemHeader) + (part == 0 ? 0 : (MPI_Offset)s->n * s->n * sizeof(double));
+    MPI_Datatype row, file_type, mem_type;
+
+    MPI_Type_contiguous((int)width, MPI_DOUBLE, &row);
+    MPI_Type_create_resized(row, 0, (MPI_Aint)(width * s->size * sizeof(double)), &file_type);
+    MPI_Type_create_resized(row, 0, (MPI_Aint)(s->ld * sizeof(double)), &mem_type);
+    MPI_Type_commit(&file_type);
+    MPI_Type_commit(&mem_type);
+
+    MPI_File_set_view(fh, base + (MPI_Offset)(s->rank * width * sizeof(double)), MPI_DOUBLE, file_type, "native", MPI_INFO_NULL);
+    double* first = s->data + (part == 0 ? 0 : s->n);
+    if (write) {
+        MPI_File_write_all(fh, first, (int)s->local_rows, mem_type, MPI_STATUS_IGNORE);
+    } else {
+        MPI_File_read_all(fh, first, (int)s->local_rows, mem_type, MPI_STATUS_IGNORE);
+    }
+    MPI_File_set_view(fh, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+
+    MPI_Type_free(&row);
+    MPI_Type_free(&file_type);
+    MPI_Type_free(&mem_type);
+}
+
+SystemHeader read_header(const char* path, MPI_Comm comm) {
+    MPI_File fh;
+    SystemHeader header = {0, 0};
+    if (MPI_File_open(comm, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Offset file_size;
+    MPI_File_read_at_all(fh, 0, &header, 2, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    MPI_File_get_size(fh, &file_size);
+    MPI_File_close(&fh);
+    if (header.n < 1 || header.nrhs < 1 || header.n > 2147483647LL) {
+        fprintf(stderr, "Error: %s is not a system file\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // Missing rows would otherwise be read as zeros and reported as a singular matrix
+    if ((double)file_size < (double)sizeof(SystemHeader) + (double)header.n * (header.n + header.nrhs) * sizeof(double)) {
+        fprintf(stderr, "Error: %s is shorter than its header says\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return header;
+}
+
+// Loads the local rows of [A | B] from path, or from the random generator when path is NULL
+void load_rows(DistSystem* s, const char* path) {
+    if (!path) {
+        generate_rows(s);
+        return;
+    }
+    MPI_File fh;
+    MPI_File_open(s->comm, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    file_rows(fh, s, 0, 0);
+    file_rows(fh, s, 1, 0);
+    MPI_File_close(&fh);
+}
+
+// Writes a random n x n system with nrhs right-hand sides, every rank writing its rows
+void generate_file(const char* path, long long n, long long nrhs) {
+    DistSystem s = alloc_dist_system(n, nrhs, MPI_COMM_WORLD);
+    MPI_File fh;
+    generate_rows(&s);
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (s.rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    SystemHeader header = {n, nrhs};
+    MPI_File_set_size(fh, (MPI_Offset)sizeof(header) + (MPI_Offset)n * (n + nrhs) * sizeof(double));
+    if (s.rank == 0) MPI_File_write_at(fh, 0, &header, 2, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    file_rows(fh, &s, 0, 1);
+    file_rows(fh, &s, 1, 1);
+    MPI_File_close(&fh);
+    if (s.rank == 0) printf("Wrote a %lld x %lld system with %lld right-hand sides to %s\n", n, n, nrhs, path);
+    free(s.data);
+}
+
+// Largest |row[k]| over the local rows that have not been a pivot yet
+Pivot local_pivot(const DistSystem* s, const char* used, long long k) {
+    Pivot best = {-1.0, -1};
+    for (long long i = 0; i < s->local_rows; i++) {
+        double v = fabs(local_row(s, i)[k]);
+        if (!used[i] && v > best.value) {
+            best.value = v;
+            best.row = (int)global_row(s, i);
+        }
+    }
+    return best;
+}
+
+/**
+ * Distributed Gauss-Jordan elimination with partial pivoting. Rows never
+ * move: pivot_of[k] records the global row chosen at step k, and at the end
+ * that row holds x_k in its B columns.
+ *
+ * Step k runs with lookahead, so that the broadcast of the next pivot row is
+ * hidden behind the bulk of the update:
+ *   1. every rank updates column k + 1 of its rows with pivot row k and finds
+ *      its local pivot candidate; MPI_Allreduce(MAXLOC) picks pivot k + 1,
+ *   2. its owner finishes updating that one row, normalises it and starts an
+ *      MPI_Ibcast of columns k + 1 .. n + nrhs - 1,
+ *   3. all ranks update the rest of their rows with pivot row k using
+ *      OpenMP threads and SIMD, the master thread calling MPI_Test to
+ *      progress the broadcast, and then wait for pivot row k + 1.
+ * Returns -1 on success or the step whose column has no nonzero pivot.
+ */
+long long dist_gauss_jordan(DistSystem* s, int* pivot_of, SolveTimes* times) {
+    long long n = s->n, cols = s->n + s->nrhs, rows = s->local_rows;
+    char* used = (char*)calloc(rows > 0 ? rows : 1, 1);
+    double* factor = (double*)malloc((rows > 0 ? rows : 1) * sizeof(double));
+    double* pivot_rows[2] = {(double*)aligned_malloc(s->ld * sizeof(double)), (double*)aligned_malloc(s->ld * sizeof(double))};
+    long long failed = -1;
+    times->compute = times->pivot_search = times->broadcast = 0.0;
+
+    // Pivot row 0 is broadcast without lookahead
+    double t0 = MPI_Wtime();
+    Pivot local = local_pivot(s, used, 0), best;
+    MPI_Allreduce(&local, &best, 1, MPI_DOUBLE_INT, MPI_MAXLOC, s->comm);
+    double t1 = MPI_Wtime();
+    times->pivot_search += t1 - t0;
+    if (best.value <= 0.0) failed = 0;
+    if (failed < 0) {
+        pivot_of[0] = best.row;
+        if (best.row % s->size == s->rank) {
+            long long i = best.row / s->size;
+            double* row = local_row(s, i);
+            double inv = 1.0 / row[0];
+            for (long long j = 0; j < cols; j++) row[j] *= inv;
+            memcpy(pivot_rows[0], row, cols * sizeof(double));
+            used[i] = 1;
+        }
+        MPI_Bcast(pivot_rows[0], (int)cols, MPI_DOUBLE, best.row % s->size, s->comm);
+        times->broadcast += MPI_Wtime() - t1;
+    }
+
+    for (long long k = 0; k < n && failed < 0; k++) {
+        double* cur = pivot_rows[k & 1];
+        double* next = pivot_rows[(k + 1) & 1];
+        long long current = pivot_of[k] % s->size == s->rank ? pivot_of[k] / s->size : -1;
+        long long next_local = -1, start = k + 1;
+        MPI_Request request = MPI_REQUEST_NULL;
+
+        // 1. Column k + 1 first, so the next pivot is known before the bulk update
+        double t_start = MPI_Wtime();
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < rows; i++) {
+            double* row = local_row(s, i);
+            factor[i] = i == current ? 0.0 : row[k];
+            if (k + 1 < n) row[k + 1] -= factor[i] * cur[k + 1];
+        }
+        times->compute += MPI_Wtime() - t_start;
+
+        if (k + 1 < n) {
+            start = k + 2;
+            t_start = MPI_Wtime();
+            local = local_pivot(s, used, k + 1);
+            MPI_Allreduce(&local, &best, 1, MPI_DOUBLE_INT, MPI_MAXLOC, s->comm);
+            times->pivot_search += MPI_Wtime() - t_start;
+            if (best.value <= 0.0) {
+                failed = k + 1;
+                break;
+            }
+            pivot_of[k + 1] = best.row;
+
+            // 2. The owner completes pivot row k + 1 and starts its broadcast
+            t_start = MPI_Wtime();
+            int owner = best.row % s->size;
+            if (owner == s->rank) {
+                next_local = best.row / s->size;
+                double* row = local_row(s, next_local);
+                double f = factor[next_local];
+                #pragma omp simd aligned(row, cur : ALIGNMENT)
+                for (long long j = start; j < cols; j++) row[j] -= f * cur[j];
+                double inv = 1.0 / row[k + 1];
+                #pragma omp simd aligned(row : ALIGNMENT)
+                for (long long j = k + 1; j < cols; j++) row[j] *= inv;
+                memcpy(next + k + 1, row + k + 1, (cols - k - 1) * sizeof(double));
+                used[next_local] = 1;
+            }
+            MPI_Ibcast(next + k + 1, (int)(cols - k - 1), MPI_DOUBLE, owner, s->comm, &request);
+            times->compute += MPI_Wtime() - t_start;
+        }
+
+        // 3. Bulk update, overlapped with the broadcast of the next pivot row
+        t_start = MPI_Wtime();
+        int arrived = request == MPI_REQUEST_NULL;
+        #pragma omp parallel for schedule(dynamic, TEST_EVERY)
+        for (long long i = 0; i < rows; i++) {
+            if (omp_get_thread_num() == 0 && !arrived && i % TEST_EVERY == 0) MPI_Test(&request, &arrived, MPI_STATUS_IGNORE);
+            double f = factor[i];
+            if (i == next_local || f == 0.0) continue;
+            double* row = local_row(s, i);
+            #pragma omp simd aligned(row, cur : ALIGNMENT)
+            for (long long j = start; j < cols; j++) row[j] -= f * cur[j];
+        }
+        double t_wait = MPI_Wtime();
+        times->compute += t_wait - t_start;
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        times->broadcast += MPI_Wtime() - t_wait;
+    }
+
+    free(used);
+    free(factor);
+    free(pivot_rows[0]);
+    free(pivot_rows[1]);
+    return failed;
+}
+
+// Floating-point operations of the elimination: (n - 1) row updates of 2 (n - k + nrhs) flops per step
+double gauss_jordan_flops(long long n, long long nrhs) {
+    return 2.0 * (n - 1) * ((double)n * (n + 1) / 2.0 + (double)n * nrhs);
+}
+
+/**
+ * Gathers X (n x nrhs, row-major) on every rank: row k of X is the B part of
+ * global row pivot_of[k]. Every rank contributes its own B rows once with
+ * MPI_Allgatherv (rank r's rows r, r + p, ... arrive as one block), and the
+ * rows are then put in solution order.
+ */
+double* gather_solution(const DistSystem* s, const int* pivot_of) {
+    long long n = s->n, nrhs = s->nrhs;
+    double* mine = (double*)malloc((s->local_rows > 0 ? s->local_rows : 1) * nrhs * sizeof(double));
+    double* all = (double*)malloc(n * nrhs * sizeof(double));
+    double* x = (double*)malloc(n * nrhs * sizeof(double));
+    int* counts = (int*)malloc(s->size * sizeof(int));
+    int* displs = (int*)malloc(s->size * sizeof(int));
+    for (int r = 0; r < s->size; r++) {
+        counts[r] = (int)(n / s->size + (r < n % s->size));
+        displs[r] = r == 0 ? 0 : displs[r - 1] + counts[r - 1];
+    }
+    for (long long i = 0; i < s->local_rows; i++) memcpy(mine + i * nrhs, local_row(s, i) + n, nrhs * sizeof(double));
+
+    // One element per B row, so the counts stay in int range
+    MPI_Datatype row;
+    MPI_Type_contiguous((int)nrhs, MPI_DOUBLE, &row);
+    MPI_Type_commit(&row);
+    MPI_Allgatherv(mine, (int)s->local_rows, row, all, counts, displs, row, s->comm);
+    MPI_Type_free(&row);
+
+    #pragma omp parallel for schedule(static)
+    for (long long k = 0; k < n; k++) {
+        long long g = pivot_of[k];
+        memcpy(x + k * nrhs, all + (displs[g % s->size] + g / s->size) * nrhs, nrhs * sizeof(double));
+    }
+    free(mine);
+    free(all);
+    free(counts);
+    free(displs);
+    return x;
+}
+
+/**
+ * Residual of X against the original system, whose rows are loaded again
+ * into the (no longer needed) local storage. Returns ||AX - B||inf and sets
+ * *relative to ||AX - B||inf / (||A||inf ||X||inf + ||B||inf).
+ */
+double residual(DistSystem* s, const char* path, const double* x, double* relative) {
+    long long n = s->n, nrhs = s->nrhs;
+    double norm[4] = {0.0, 0.0, 0.0, 0.0}; // ||AX - B||, ||A||, ||B||, ||X||
+
+    load_rows(s, path);
+    double norm_r = 0.0, norm_a = 0.0, norm_b = 0.0, norm_x = 0.0;
+    #pragma omp parallel reduction(max:norm_r, norm_a, norm_b, norm_x)
+    {
+        double* r = (double*)malloc(nrhs * sizeof(double));
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < s->local_rows; i++) {
+            const double* row = local_row(s, i);
+            double row_a = 0.0, row_r = 0.0, row_b = 0.0;
+            for (long long c = 0; c < nrhs; c++) r[c] = -row[n + c];
+            for (long long j = 0; j < n; j++) {
+                row_a += fabs(row[j]);
+                #pragma omp simd
+                for (long long c = 0; c < nrhs; c++) r[c] += row[j] * x[j * nrhs + c];
+            }
+            for (long long c = 0; c < nrhs; c++) {
+                row_r += fabs(r[c]);
+                row_b += fabs(row[n + c]);
+            }
+            if (row_r > norm_r) norm_r = row_r;
+            if (row_a > norm_a) norm_a = row_a;
+            if (row_b > norm_b) norm_b = row_b;
+        }
+        // X is replicated, every rank checks the rows k = rank, rank + size, ...
+        #pragma omp for schedule(static)
+        for (long long k = s->rank; k < n; k += s->size) {
+            double row_x = 0.0;
+            for (long long c = 0; c < nrhs; c++) row_x += fabs(x[k * nrhs + c]);
+            if (row_x > norm_x) norm_x = row_x;
+        }
+        free(r);
+    }
+    double local[4] = {norm_r, norm_a, norm_b, norm_x};
+    MPI_Allreduce(local, norm, 4, MPI_DOUBLE, MPI_MAX, s->comm);
+    *relative = norm[0] / (norm[1] * norm[3] + norm[2]);
+    return norm[0];
+}
+
+/**
+ * Solves the system in path (or a random n x n one when path is NULL) on the
+ * ranks of comm. Returns the wall time of the elimination and sets the phase
+ * times (maxima over ranks), the residuals and, when out_path is given,
+ * writes X from rank 0.
+ */
+double solve(const char* path, long long n, long long nrhs, const char* out_path, MPI_Comm comm,
+             SolveTimes* times, double* t_read, double* t_check, double* resid, double* relative) {
+    double start = MPI_Wtime();
+    DistSystem s = alloc_dist_system(n, nrhs, comm);
+    int* pivot_of = (int*)malloc(n * sizeof(int));
+    load_rows(&s, path);
+    *t_read = MPI_Wtime() - start;
+
+    SolveTimes local;
+    MPI_Barrier(comm);
+    start = MPI_Wtime();
+    long long failed = dist_gauss_jordan(&s, pivot_of, &local);
+    double elapsed = MPI_Wtime() - start, t_solve;
+    MPI_Allreduce(&elapsed, &t_solve, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&local, times, 3, MPI_DOUBLE, MPI_MAX, comm);
+    if (failed >= 0) {
+        if (s.rank == 0) fprintf(stderr, "Error: the matrix is singular (no nonzero pivot in column %lld)\n", failed);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    start = MPI_Wtime();
+    double* x = gather_solution(&s, pivot_of);
+    *resid = residual(&s, path, x, relative);
+    *t_check = MPI_Wtime() - start;
+
+    if (out_path && s.rank == 0) {
+        FILE* f = fopen(out_path, "wb");
+        if (!f) {
+            fprintf(stderr, "Error: cannot open %s for writing\n", out_path);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        fwrite(x, sizeof(double), n * nrhs, f);
+        fclose(f);
+    }
+    free(x);
+    free(pivot_of);
+    free(s.data);
+    return t_solve;
+}
+
+void solve_file(const char* path, const char* out_path, int rank, int size) {
+    SystemHeader header = read_header(path, MPI_COMM_WORLD);
+    SolveTimes times;
+    double t_read, t_check, resid, relative;
+    double t_solve = solve(path, header.n, header.nrhs, out_path, MPI_COMM_WORLD, &times, &t_read, &t_check, &resid, &relative);
+
+    if (rank == 0) {
+        printf("Solved a %lld x %lld system with %lld right-hand sides using %d processes x %d threads\n",
+               header.n, header.n, header.nrhs, size, omp_get_max_threads());
+        printf("Read: %.3f s | solve: %.3f s (%.2f GFLOP/s) | residual check: %.3f s\n",
+               t_read, t_solve, gauss_jordan_flops(header.n, header.nrhs) / t_solve / 1e9, t_check);
+        printf("Solve split (max over ranks): compute %.3f s | pivot search %.3f s | row broadcast %.3f s\n",
+               times.compute, times.pivot_search, times.broadcast);
+        printf("||AX - B||inf = %.3e, relative residual = %.3e\n", resid, relative);
+        printf("Execution time: %.6f seconds\n", t_solve);
+    }
+}
+
+/**
+ * Weak scaling on 1, 2, 4, ... and all ranks. Elimination work grows as n^3,
+ * so p ranks solve a random system of n = n1 * cbrt(p), keeping the flops
+ * per rank constant; the efficiency is t(1) / t(p).
+ */
+void run_weak_scaling(long long n1, int rank, int size) {
+    double t_one = 0.0;
+
+    if (rank == 0) {
+        printf("Weak scaling: n = %lld * cbrt(procs), 1 right-hand side, %d threads per process (times in s, maxima over ranks)\n",
+               n1, omp_get_max_threads());
+        printf("%-6s | %-7s | %-9s | %-9s | %-9s | %-9s | %-9s | %s\n", "procs", "n", "compute", "pivot", "bcast", "total", "GFLOP/s", "efficiency");
+    }
+    for (int p = 1; p <= size; p = (p * 2 > size && p < size) ? size : p * 2) {
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+
+        if (comm != MPI_COMM_NULL) {
+            long long n = (long long)llround(n1 * cbrt((double)p));
+            SolveTimes times;
+            double t_read, t_check, resid, relative;
+            double t_solve = solve(NULL, n, 1, NULL, comm, &times, &t_read, &t_check, &resid, &relative);
+            if (relative > 1e-10) {
+                if (rank == 0) fprintf(stderr, "Error: relative residual %.3e on %d processes\n", relative, p);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            if (p == 1) t_one = t_solve;
+            if (rank == 0) {
+                printf("%-6d | %-7lld | %-9.4f | %-9.4f | %-9.4f | %-9.4f | %-9.2f | %.2f\n", p, n, times.compute, times.pivot_search,
+                       times.broadcast, t_solve, gauss_jordan_flops(n, 1) / t_solve / 1e9, t_one / t_solve);
+            }
+            MPI_Comm_free(&comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s -g <file> <n> [nrhs]\n", prog);
+    printf("       %s -f <file> [solution_out]\n", prog);
+    printf("       %s -W [n_one_process]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size, provided;
+
+    // Only the master thread of each rank calls MPI (the MPI_Test inside the update loop)
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) fprintf(stderr, "Error: the MPI library does not support MPI_THREAD_FUNNELED\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "-g") == 0) {
+        long long n = atoll(argv[3]), nrhs = argc == 5 ? atoll(argv[4]) : 1;
+        if (n < 1 || nrhs < 1 || n > 2147483647LL) {
+            if (rank == 0) printf("Error: n and nrhs must be positive (and n below 2^31).\n");
+            MPI_Finalize();
+            return 1;
+        }
+        generate_file(argv[2], n, nrhs);
+    } else if ((argc == 3 || argc == 4) && strcmp(argv[1], "-f") == 0) {
+        solve_file(argv[2], argc == 4 ? argv[3] : NULL, rank, size);
+    } else if ((argc == 2 || argc == 3) && strcmp(argv[1], "-W") == 0) {
+        long long n1 = argc == 3 ? atoll(argv[2]) : 1024;
+        if (n1 < 2) {
+            if (rank == 0) printf("Error: n must be at least 2.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        run_weak_scaling(n1, rank, size);
+    } else {
+        if (rank == 0) print_usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -32,30 +32,47 @@ void hypercube_broadcast(int d, int my_id, int source, int *X, int n) {
 }
 
 int main(int argc, char **argv) {
-    int d, source, n = 1, X[1];
+    int d, source, n = 1;
     MPI_Init(&argc, &argv);
 
     int my_id, p;
     MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
     MPI_Comm_size(MPI_COMM_WORLD, &p);
 
-    if (argc < 3) {
-        if (my_id == 0) printf("Usage: %s <dimension d> <source node>\n", argv[0]);
+    if (argc < 3 || argc > 4) {
+        if (my_id == 0) printf("Usage: %s <dimension d> <source node> [message_length]\n", argv[0]);
         MPI_Finalize();
         return 1;
     }
 
     d = atoi(argv[1]);
     source = atoi(argv[2]);
+    if (argc == 4) n = atoi(argv[3]);
+    if (n < 1) {
+        if (my_id == 0) printf("Error: message_length must be a positive integer.\n");
+        MPI_Finalize();
+        return 1;
+    }
 
-    // Example: one integer message
-    if (my_id == source)
-        X[0] = 42; // Or any value you want to broadcast
+    // Example: a message of n integers
+    int *X = (int *)malloc(n * sizeof(int));
+    for (int j = 0; j < n; j++)
+        X[j] = my_id == source ? 42 : 0; // Or any value you want to broadcast
 
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
     hypercube_broadcast(d, my_id, source, X, n);
+    double elapsed = MPI_Wtime() - start_time, max_elapsed;
 
     printf("Rank %d: Final value X = %d\n", my_id, X[0]);
 
+    // The broadcast ends when the last node has received the message
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (my_id == 0)
+        printf("Execution time: %.6f seconds\n", max_elapsed);
+
+    free(X);
+
     MPI_Finalize();
     return 0;
 }
@@ -22,11 +22,12 @@ void hypercube_reduce(int d, int my_id, int dest, int *X, int *sum, int n) {
                 MPI_Send(sum, n, MPI_INT, msg_dest, 0, MPI_COMM_WORLD);
             } else {
                 int msg_source = my_id ^ (1 << i);
-                int recv_buf[n];
+                int *recv_buf = (int *)malloc(n * sizeof(int));
                 printf("Rank %d: Receiving sum from %d at step %d\n", my_id, msg_source, i);
                 MPI_Recv(recv_buf, n, MPI_INT, msg_source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
                 for (int j = 0; j < n; j++)
                     sum[j] += recv_buf[j];
+                free(recv_buf);
             }
         }
         mask = mask ^ (1 << i); // Set bit i of mask to 1
@@ -34,30 +35,50 @@ void hypercube_reduce(int d, int my_id, int dest, int *X, int *sum, int n) {
 }
 
 int main(int argc, char **argv) {
-    int d, dest, n = 1, X[1], sum[1];
+    int d, dest, n = 1;
     MPI_Init(&argc, &argv);
 
     int my_id, p;
     MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
     MPI_Comm_size(MPI_COMM_WORLD, &p);
 
-    if (argc < 3) {
-        if (my_id == 0) printf("Usage: %s <dimension d> <destination node>\n", argv[0]);
+    if (argc < 3 || argc > 4) {
+        if (my_id == 0) printf("Usage: %s <dimension d> <destination node> [message_length]\n", argv[0]);
         MPI_Finalize();
         return 1;
     }
 
     d = atoi(argv[1]);
     dest = atoi(argv[2]);
+    if (argc == 4) n = atoi(argv[3]);
+    if (n < 1) {
+        if (my_id == 0) printf("Error: message_length must be a positive integer.\n");
+        MPI_Finalize();
+        return 1;
+    }
 
-    // Example: each node contributes its own rank
-    X[0] = my_id;
+    // Example: each node contributes its own rank in each of the n integers
+    int *X = (int *)malloc(n * sizeof(int));
+    int *sum = (int *)malloc(n * sizeof(int));
+    for (int j = 0; j < n; j++)
+        X[j] = my_id;
 
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
     hypercube_reduce(d, my_id, dest, X, sum, n);
+    double elapsed = MPI_Wtime() - start_time, max_elapsed;
 
     if (my_id == dest)
         printf("Rank %d: Final reduced sum = %d\n", my_id, sum[0]);
 
+    // The reduction ends when the last message has been combined
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (my_id == 0)
+        printf("Execution time: %.6f seconds\n", max_elapsed);
+
+    free(X);
+    free(sum);
+
     MPI_Finalize();
     return 0;
 }
@@ -1,7 +1,7 @@
 /*
  * Author: canetizen
  * Created on Sat May 24 2025
- * Description: MPI implementation for maze solving. 
+ * Description: MPI implementation for maze solving.
  */
 
 #include <mpi.h>
@@ -9,15 +9,19 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define N 5
+#define DEFAULT_N 5
 #define START_X 0
 #define START_Y 0
-#define END_X 4
-#define END_Y 4
-#define MAX_PATH_LEN 100
+#define WALL_PERCENT 30     // Wall density of generated mazes
+#define MAX_PRINTED_MOVES 64
+#define POLL_INTERVAL 16    // Expansions between two checks of the shared "solved" flag
+#define NO_WINNER -1
+#define TAG_LAYER_COUNT 1
+#define TAG_LAYER_CELLS 2
+#define TAG_PATH 3
 
-// Maze: 0 = free, 1 = wall
-int maze[N][N] = {
+// Default maze: 0 = free, 1 = wall
+int default_maze[DEFAULT_N][DEFAULT_N] = {
     {0, 1, 0, 0, 0},
     {0, 1, 0, 1, 0},
     {0, 0, 0, 1, 0},
@@ -25,86 +29,579 @@ int maze[N][N] = {
     {1, 0, 0, 0, 0}
 };
 
-// Direction vectors: up, down, left, right
+// Active maze: n x n cells in row-major order, cell index = x * n + y
+int n = DEFAULT_N;
+unsigned char* maze;
+int end_x, end_y;
+
+// Direction vectors: up, down, left, right (opposite direction of d is d ^ 1)
 int dx[4] = {-1, 1, 0, 0};
 int dy[4] = {0, 0, -1, 1};
 const char* dir_names[4] = {"Up", "Down", "Left", "Right"};
 
+// Cooperative cancellation state: rank 0 exposes the winner rank in an RMA window
+MPI_Win winner_win;
+long expansions = 0;   // Cells expanded by this rank (instrumentation)
+int cancelled = 0;     // Set once another rank has reached the goal
+
+// Cheap remote read of the winner flag, performed every POLL_INTERVAL expansions
+int solved_elsewhere(void) {
+    int winner;
+    MPI_Fetch_and_op(NULL, &winner, MPI_INT, 0, 0, MPI_NO_OP, winner_win);
+    MPI_Win_flush(0, winner_win);
+    return winner != NO_WINNER;
+}
+
+// Atomically claim the solution; returns 1 only for the first rank to arrive
+int claim_solution(int rank) {
+    int expected = NO_WINNER, previous;
+    MPI_Compare_and_swap(&rank, &expected, &previous, MPI_INT, 0, 0, winner_win);
+    MPI_Win_flush(0, winner_win);
+    return previous == NO_WINNER;
+}
+
+// Fills the maze with random walls, keeping the start and goal cells free
+void generate_maze(unsigned int seed) {
+    srand(seed);
+    for (int i = 0; i < n * n; i++) {
+        maze[i] = (rand() % 100) < WALL_PERCENT;
+    }
+    maze[START_X * n + START_Y] = 0;
+    maze[end_x * n + end_y] = 0;
+}
+
 // Validity check for next move
-int is_valid(int x, int y, int visited[N][N]) {
-    return (x >= 0 && x < N && y >= 0 && y < N &&
-            maze[x][y] == 0 && visited[x][y] == 0);
+int is_valid(int x, int y, const unsigned char* visited) {
+    return (x >= 0 && x < n && y >= 0 && y < n &&
+            maze[x * n + y] == 0 && visited[x * n + y] == 0);
 }
 
-// Recursive DFS with path tracking
-int dfs(int x, int y, int visited[N][N], int path[], int depth) {
-    if (x == END_X && y == END_Y) {
-        return 1;  // Goal reached
+// Manhattan distance to the goal, used as the A* heuristic
+int manhattan(int x, int y) {
+    return abs(x - end_x) + abs(y - end_y);
+}
+
+void print_path(const int path[], int path_len) {
+    if (path_len > MAX_PRINTED_MOVES) {
+        printf("Path: %d moves (too long to print)\n", path_len);
+        return;
+    }
+    printf("Path: ");
+    for (int i = 0; i < path_len; i++) {
+        printf("%s ", dir_names[path[i]]);
     }
+    printf("\n");
+}
 
-    visited[x][y] = 1;
+void print_report(const char* mode, long cells_expanded, int path_len, double seconds) {
+    printf("Mode: %-6s | cells expanded: %10ld | path length: %7d | wall time: %.6f s\n",
+           mode, cells_expanded, path_len, seconds);
+}
 
-    for (int d = 0; d < 4; d++) {
-        int nx = x + dx[d];
-        int ny = y + dy[d];
+/**
+ * Iterative DFS with path tracking. Visited cells stay marked after
+ * backtracking, so each cell is expanded at most once; path[d] holds the move
+ * taken at depth d. Returns the path length
+ * when the goal is reached, or 0 if it is unreachable or the search was cancelled.
+ */
+int dfs(int x, int y, unsigned char* visited, int path[], int depth) {
+    int* cell = (int*)malloc((n * n + 1) * sizeof(int));
+    int* next_dir = (int*)malloc((n * n + 1) * sizeof(int));
+    int top = depth;
+    int result = 0;
 
-        if (is_valid(nx, ny, visited)) {
-            path[depth] = d;
-            if (dfs(nx, ny, visited, path, depth + 1)) {
-                return 1;
+    cell[top] = x * n + y;
+    next_dir[top] = -1;  // -1 = cell not entered yet
+
+    while (top >= depth) {
+        int c = cell[top];
+        int cx = c / n, cy = c % n;
+
+        if (next_dir[top] == -1) {
+            if (cx == end_x && cy == end_y) {
+                result = top;  // Goal reached
+                break;
             }
+
+            // Periodically check whether another rank already solved the maze
+            if (++expansions % POLL_INTERVAL == 0 && solved_elsewhere()) {
+                cancelled = 1;
+            }
+            if (cancelled) {
+                break;
+            }
+
+            visited[c] = 1;
+            next_dir[top] = 0;
+        }
+
+        if (next_dir[top] == 4) {
+            top--;  // Backtrack; the cell stays visited since it cannot reach the goal
+            continue;
+        }
+
+        int d = next_dir[top]++;
+        int nx = cx + dx[d];
+        int ny = cy + dy[d];
+        if (is_valid(nx, ny, visited)) {
+            path[top] = d;
+            top++;
+            cell[top] = nx * n + ny;
+            next_dir[top] = -1;
         }
     }
 
-    visited[x][y] = 0;
-    return 0;
+    free(cell);
+    free(next_dir);
+    return result;
 }
 
-int main(int argc, char** argv) {
-    int rank, size;
-    int found = 0;
-    int global_found;
+/**
+ * DFS mode: each of the first 4 ranks explores one initial direction from the
+ * start cell. The first rank to reach the goal cancels the others.
+ */
+void run_dfs(int rank, int size) {
+    int found = 0, global_found;
+    int path_len = 0, global_path_len;
+    long total_expansions;
 
-    MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    expansions = 0;
+    cancelled = 0;
 
+    // Only rank 0 holds memory for the winner flag; everyone else accesses it remotely
+    int* winner_slot;
+    MPI_Win_allocate(rank == 0 ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &winner_slot, &winner_win);
     if (rank == 0) {
-        printf("MPI Maze Solver with %d processes\n", size);
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, winner_win);
+        *winner_slot = NO_WINNER;
+        MPI_Win_unlock(0, winner_win);
     }
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, winner_win);
+
+    double start_time = MPI_Wtime();
+    double solve_time = 0.0;
 
     if (rank < 4) {  // Only 4 directions possible from start
-        int visited[N][N] = {0};
-        int path[MAX_PATH_LEN];
-        memset(path, -1, sizeof(path));
+        unsigned char* visited = (unsigned char*)calloc(n * n, 1);
+        int* path = (int*)malloc((n * n + 1) * sizeof(int));
 
         int nx = START_X + dx[rank];
         int ny = START_Y + dy[rank];
 
         if (is_valid(nx, ny, visited)) {
-            visited[START_X][START_Y] = 1;
+            visited[START_X * n + START_Y] = 1;
             path[0] = rank;  // First move
 
-            if (dfs(nx, ny, visited, path, 1)) {
+            path_len = dfs(nx, ny, visited, path, 1);
+            if (path_len > 0 && claim_solution(rank)) {
                 found = 1;
-                printf("Rank %d: Path found!\nPath: ", rank);
-                for (int i = 0; i < MAX_PATH_LEN && path[i] != -1; i++) {
-                    printf("%s ", dir_names[path[i]]);
-                }
-                printf("\n");
+                solve_time = MPI_Wtime() - start_time;
+                printf("Rank %d: Path found!\n", rank);
+                print_path(path, path_len);
+            } else {
+                path_len = 0;
             }
         }
+
+        free(visited);
+        free(path);
     }
 
+    double search_time = MPI_Wtime() - start_time;
+    MPI_Win_unlock_all(winner_win);
+
     MPI_Reduce(&found, &global_found, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&path_len, &global_path_len, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&expansions, &total_expansions, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    // Instrumentation: per-rank expansions and time spent searching
+    long* all_expansions = NULL;
+    double* all_times = NULL;
+    double first_solution_time, last_stop_time;
+    if (rank == 0) {
+        all_expansions = (long*)malloc(size * sizeof(long));
+        all_times = (double*)malloc(size * sizeof(double));
+    }
+    MPI_Gather(&expansions, 1, MPI_LONG, all_expansions, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+    MPI_Gather(&search_time, 1, MPI_DOUBLE, all_times, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&solve_time, &first_solution_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&search_time, &last_stop_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
 
     if (rank == 0) {
         if (global_found)
             printf("A solution was found.\n");
         else
             printf("No solution exists.\n");
+
+        for (int i = 0; i < size; i++) {
+            printf("Rank %d: %ld expansions, stopped after %.6f s\n", i, all_expansions[i], all_times[i]);
+        }
+        if (global_found) {
+            printf("Time to first solution: %.6f s\n", first_solution_time);
+        }
+        // Without a solution the search lasts until the slowest rank has exhausted its branch
+        print_report("dfs", total_expansions, global_path_len, global_found ? first_solution_time : last_stop_time);
+        free(all_expansions);
+        free(all_times);
+    }
+
+    MPI_Win_free(&winner_win);
+}
+
+// One BFS tree of the bidirectional search
+typedef struct {
+    int* dist;        // Depth of each cell in this tree, -1 if unseen
+    int* parent_dir;  // Move used to enter the cell from its parent
+    int* layer;       // Cells discovered in the most recent round
+    int layer_len;
+    int* next;        // Scratch buffer for the next layer
+} BfsTree;
+
+void init_tree(BfsTree* t, int root) {
+    t->dist = (int*)malloc(n * n * sizeof(int));
+    t->parent_dir = (int*)malloc(n * n * sizeof(int));
+    t->layer = (int*)malloc(n * n * sizeof(int));
+    t->next = (int*)malloc(n * n * sizeof(int));
+    memset(t->dist, -1, n * n * sizeof(int));
+    t->dist[root] = 0;
+    t->parent_dir[root] = -1;
+    t->layer[0] = root;
+    t->layer_len = 1;
+}
+
+void free_tree(BfsTree* t) {
+    free(t->dist);
+    free(t->parent_dir);
+    free(t->layer);
+    free(t->next);
+}
+
+// Expands every cell of the current layer; the newly discovered cells become the layer
+void expand_layer(BfsTree* t) {
+    int next_len = 0;
+    for (int i = 0; i < t->layer_len; i++) {
+        int c = t->layer[i];
+        int cx = c / n, cy = c % n;
+        expansions++;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dx[d];
+            int ny = cy + dy[d];
+            if (nx < 0 || nx >= n || ny < 0 || ny >= n) continue;
+            int nc = nx * n + ny;
+            if (maze[nc] == 0 && t->dist[nc] == -1) {
+                t->dist[nc] = t->dist[c] + 1;
+                t->parent_dir[nc] = d;
+                t->next[next_len++] = nc;
+            }
+        }
     }
+    int* tmp = t->layer;
+    t->layer = t->next;
+    t->next = tmp;
+    t->layer_len = next_len;
+}
+
+// Sends this rank's new layer to the peer and stores the peer's layer in 'other'
+void exchange_layer(BfsTree* mine, BfsTree* other, int peer, int round) {
+    MPI_Sendrecv(&mine->layer_len, 1, MPI_INT, peer, TAG_LAYER_COUNT,
+                 &other->layer_len, 1, MPI_INT, peer, TAG_LAYER_COUNT,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(mine->layer, mine->layer_len, MPI_INT, peer, TAG_LAYER_CELLS,
+                 other->layer, other->layer_len, MPI_INT, peer, TAG_LAYER_CELLS,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    for (int i = 0; i < other->layer_len; i++) {
+        other->dist[other->layer[i]] = round;
+    }
+}
+
+/**
+ * Returns the meeting cell with the smallest total distance among the cells
+ * discovered in this round, or -1 if the two trees have not met yet.
+ * A new meeting point always involves a cell from one of the latest layers.
+ */
+int find_meeting_cell(const BfsTree* fwd, const BfsTree* bwd) {
+    int best = -1, best_len = 0;
+    const BfsTree* trees[2] = {fwd, bwd};
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < trees[t]->layer_len; i++) {
+            int c = trees[t]->layer[i];
+            if (fwd->dist[c] < 0 || bwd->dist[c] < 0) continue;
+            int len = fwd->dist[c] + bwd->dist[c];
+            if (best == -1 || len < best_len || (len == best_len && c < best)) {
+                best = c;
+                best_len = len;
+            }
+        }
+    }
+    return best;
+}
+
+// Moves from the tree root to cell c, written to path[0..dist-1]
+void trace_from_root(const BfsTree* t, int c, int path[]) {
+    for (int i = t->dist[c] - 1; i >= 0; i--) {
+        int d = t->parent_dir[c];
+        path[i] = d;
+        c = (c / n - dx[d]) * n + (c % n - dy[d]);
+    }
+}
+
+// Moves from cell c back to the tree root (the goal for the backward tree)
+void trace_to_root(const BfsTree* t, int c, int path[]) {
+    int len = t->dist[c];
+    for (int i = 0; i < len; i++) {
+        int d = t->parent_dir[c];
+        path[i] = d ^ 1;
+        c = (c / n - dx[d]) * n + (c % n - dy[d]);
+    }
+}
+
+/**
+ * Bidirectional BFS mode: one frontier grows from the start and one from the
+ * goal, one layer per round, until they meet. With 2 or more processes rank 0
+ * owns the forward frontier and rank 1 the backward one, exchanging each new
+ * layer; with a single process both frontiers are expanded locally.
+ */
+void run_bidirectional(int rank, int size) {
+    int distributed = size >= 2;
+    int path_len = 0;
+    long total_expansions;
+
+    expansions = 0;
+    double start_time = MPI_Wtime();
+
+    if (rank < 2) {
+        BfsTree fwd, bwd;
+        init_tree(&fwd, START_X * n + START_Y);
+        init_tree(&bwd, end_x * n + end_y);
+        int peer = 1 - rank;
+        int meet = find_meeting_cell(&fwd, &bwd);
+
+        for (int round = 1; meet == -1 && fwd.layer_len > 0 && bwd.layer_len > 0; round++) {
+            if (!distributed) {
+                expand_layer(&fwd);
+                expand_layer(&bwd);
+            } else if (rank == 0) {
+                expand_layer(&fwd);
+                exchange_layer(&fwd, &bwd, peer, round);
+            } else {
+                expand_layer(&bwd);
+                exchange_layer(&bwd, &fwd, peer, round);
+            }
+            meet = find_meeting_cell(&fwd, &bwd);
+        }
+
+        // Both ranks saw the same layers, so they agree on the meeting cell
+        if (meet != -1) {
+            int* path = (int*)malloc((n * n + 1) * sizeof(int));
+            int fwd_len = fwd.dist[meet];
+            int bwd_len = bwd.dist[meet];
+            if (!distributed) {
+                trace_from_root(&fwd, meet, path);
+                trace_to_root(&bwd, meet, path + fwd_len);
+            } else if (rank == 0) {
+                trace_from_root(&fwd, meet, path);
+                MPI_Recv(path + fwd_len, bwd_len, MPI_INT, peer, TAG_PATH, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            } else {
+                trace_to_root(&bwd, meet, path);
+                MPI_Send(path, bwd_len, MPI_INT, peer, TAG_PATH, MPI_COMM_WORLD);
+            }
+            path_len = fwd_len + bwd_len;
+            if (rank == 0) {
+                printf("Frontiers met at (%d, %d)\n", meet / n, meet % n);
+                print_path(path, path_len);
+            }
+            free(path);
+        } else if (rank == 0) {
+            printf("No solution exists.\n");
+        }
+
+        free_tree(&fwd);
+        free_tree(&bwd);
+    }
+
+    double elapsed = MPI_Wtime() - start_time;
+    MPI_Reduce(&expansions, &total_expansions, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        print_report("bibfs", total_expansions, path_len, elapsed);
+    }
+}
+
+// Binary min-heap entry; the packed key compares (f, h) in one integer comparison
+typedef struct {
+    unsigned long long key;
+    int cell;
+} HeapNode;
+
+typedef struct {
+    HeapNode* nodes;
+    int len, cap;
+} MinHeap;
+
+void heap_push(MinHeap* h, unsigned long long key, int cell) {
+    if (h->len == h->cap) {
+        h->cap *= 2;
+        h->nodes = (HeapNode*)realloc(h->nodes, h->cap * sizeof(HeapNode));
+    }
+    int i = h->len++;
+    while (i > 0 && h->nodes[(i - 1) / 2].key > key) {
+        h->nodes[i] = h->nodes[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->nodes[i].key = key;
+    h->nodes[i].cell = cell;
+}
+
+HeapNode heap_pop(MinHeap* h) {
+    HeapNode top = h->nodes[0];
+    HeapNode last = h->nodes[--h->len];
+    int i = 0;
+    while (2 * i + 1 < h->len) {
+        int child = 2 * i + 1;
+        if (child + 1 < h->len && h->nodes[child + 1].key < h->nodes[child].key) child++;
+        if (last.key <= h->nodes[child].key) break;
+        h->nodes[i] = h->nodes[child];
+        i = child;
+    }
+    h->nodes[i] = last;
+    return top;
+}
+
+/**
+ * A* mode with the Manhattan heuristic, run by rank 0. Ties on f = g + h are
+ * broken towards the smaller h (the deeper node), which keeps the number of
+ * expanded cells low on open grids.
+ */
+void run_astar(int rank) {
+    if (rank != 0) return;
+
+    expansions = 0;
+    double start_time = MPI_Wtime();
+
+    int* g = (int*)malloc(n * n * sizeof(int));
+    int* parent_dir = (int*)malloc(n * n * sizeof(int));
+    unsigned char* closed = (unsigned char*)calloc(n * n, 1);
+    memset(g, -1, n * n * sizeof(int));
+
+    MinHeap heap;
+    heap.cap = 1024;
+    heap.len = 0;
+    heap.nodes = (HeapNode*)malloc(heap.cap * sizeof(HeapNode));
+
+    int start = START_X * n + START_Y;
+    int goal = end_x * n + end_y;
+    g[start] = 0;
+    unsigned long long h0 = manhattan(START_X, START_Y);
+    heap_push(&heap, (h0 << 32) | h0, start);
+
+    int found = 0;
+    while (heap.len > 0) {
+        int c = heap_pop(&heap).cell;
+        if (closed[c]) continue;  // Stale entry
+        closed[c] = 1;
+        expansions++;
+        if (c == goal) {
+            found = 1;
+            break;
+        }
+
+        int cx = c / n, cy = c % n;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dx[d];
+            int ny = cy + dy[d];
+            if (nx < 0 || nx >= n || ny < 0 || ny >= n) continue;
+            int nc = nx * n + ny;
+            if (maze[nc] != 0 || closed[nc]) continue;
+            if (g[nc] == -1 || g[c] + 1 < g[nc]) {
+                g[nc] = g[c] + 1;
+                parent_dir[nc] = d;
+                unsigned long long h = manhattan(nx, ny);
+                heap_push(&heap, ((g[nc] + h) << 32) | h, nc);
+            }
+        }
+    }
+
+    int path_len = 0;
+    if (found) {
+        path_len = g[goal];
+        int* path = (int*)malloc((path_len + 1) * sizeof(int));
+        for (int i = path_len - 1, c = goal; i >= 0; i--) {
+            int d = parent_dir[c];
+            path[i] = d;
+            c = (c / n - dx[d]) * n + (c % n - dy[d]);
+        }
+        print_path(path, path_len);
+        free(path);
+    } else {
+        printf("No solution exists.\n");
+    }
+
+    print_report("astar", expansions, path_len, MPI_Wtime() - start_time);
+
+    free(g);
+    free(parent_dir);
+    free(closed);
+    free(heap.nodes);
+}
+
+int main(int argc, char** argv) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Usage: [dfs|bibfs|astar|bench] [maze_size seed]
+    const char* mode = argc > 1 ? argv[1] : "dfs";
+    if (strcmp(mode, "dfs") != 0 && strcmp(mode, "bibfs") != 0 &&
+        strcmp(mode, "astar") != 0 && strcmp(mode, "bench") != 0) {
+        if (rank == 0) printf("Usage: %s [dfs|bibfs|astar|bench] [maze_size seed]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (argc > 2) {
+        n = atoi(argv[2]);
+        if (n < 2) {
+            if (rank == 0) printf("Error: maze_size must be at least 2.\n");
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    end_x = n - 1;
+    end_y = n - 1;
+
+    maze = (unsigned char*)malloc(n * n);
+    if (argc > 2) {
+        // Rank 0 generates the maze so every rank works on identical data
+        if (rank == 0) generate_maze(argc > 3 ? (unsigned int)atoi(argv[3]) : 1);
+        MPI_Bcast(maze, n * n, MPI_UNSIGNED_CHAR, 0, MPI_COMM_WORLD);
+    } else {
+        for (int i = 0; i < n * n; i++) maze[i] = default_maze[i / n][i % n];
+    }
+
+    if (rank == 0) {
+        printf("MPI Maze Solver with %d processes (%dx%d maze, mode %s)\n", size, n, n, mode);
+    }
+
+    int bench = strcmp(mode, "bench") == 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    if (bench && size < 4) {
+        // With fewer than 4 processes some start directions are never explored
+        if (rank == 0) printf("Mode: dfs skipped (needs 4 processes, running with %d)\n", size);
+    } else if (bench || strcmp(mode, "dfs") == 0) {
+        run_dfs(rank, size);
+    }
+    if (bench || strcmp(mode, "bibfs") == 0) run_bidirectional(rank, size);
+    if (bench || strcmp(mode, "astar") == 0) run_astar(rank);
+
+    // Whole run of the selected mode(s), reports included; the per-mode rows above give each search's own time
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) printf("Execution time: %.6f seconds\n", MPI_Wtime() - start_time);
 
+    free(maze);
     MPI_Finalize();
     return 0;
 }
@@ -1,14 +1,19 @@
 /*
  * Author: canetizen
  * Created on Fri May 23 2025
- * Description: MPI implementation of the naive string matching algorithm.
+ * Description: MPI implementation of parallel string matching with naive, Horspool, Two-Way and SIMD engines.
  */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <limits.h> // For INT_MAX sentinel value
+#include <limits.h> // For LLONG_MAX sentinel value
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define SCAN_BLOCK (1 << 20) // Positions scanned between two checks of the global best match
 
 /**
  * Computes the start index and length of the chunk assigned to a specific rank.
@@ -55,93 +60,895 @@ void extract_chunk(char* chunk, const char* text, int start, int length) {
 }
 
 /**
- * Entry point: performs parallel string matching using naive algorithm.
- * Distributes the workload among MPI processes and finds the earliest match.
+ * Broadcasts a NUL-terminated string owned by the master process.
+ * Worker processes receive a freshly allocated copy.
  */
-int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
-
-    int rank, size;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);   // Get current process rank
-    MPI_Comm_size(MPI_COMM_WORLD, &size);   // Get total number of processes
-
-    char* text = NULL;
-    char* pattern = NULL;
-    int text_len = 0, pattern_len = 0;
-
-    // Master process parses input arguments
-    if (rank == 0) {
-        if (argc != 3) {
-            fprintf(stderr, "Usage: %s <text> <pattern>\n", argv[0]);
-            MPI_Abort(MPI_COMM_WORLD, 1);
-        }
-
-        text = argv[1];
-        pattern = argv[2];
-        text_len = strlen(text);
-        pattern_len = strlen(pattern);
-    }
+char* broadcast_string(char* str, int rank) {
+    int len = (rank == 0) ? (int)strlen(str) : 0;
+    MPI_Bcast(&len, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank != 0) str = (char*)malloc(len + 1);
+    MPI_Bcast(str, len + 1, MPI_CHAR, 0, MPI_COMM_WORLD);
+    return str;
+}
 
-    // Broadcast lengths of text and pattern to all processes
+/**
+ * Broadcast distribution: the whole text is broadcast to every process and each
+ * process copies its overlapping chunk out of it. Memory per process is O(text size).
+ * Both distributions report in 'owned' how many leading chunk positions belong to
+ * this process; matches starting in the overlap after them belong to the next one.
+ */
+char* distribute_by_broadcast(char* text, int pattern_len, int rank, int size, long long* start, int* length, int* owned) {
+    int text_len = (rank == 0) ? (int)strlen(text) : 0;
     MPI_Bcast(&text_len, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&pattern_len, 1, MPI_INT, 0, MPI_COMM_WORLD);
-
-    // Broadcast the pattern string to all processes
-    if (rank != 0) pattern = (char*)malloc(pattern_len + 1);
-    MPI_Bcast(pattern, pattern_len + 1, MPI_CHAR, 0, MPI_COMM_WORLD);
 
     // Broadcast the entire input text to all processes
     if (rank != 0) text = (char*)malloc(text_len + 1);
     MPI_Bcast(text, text_len + 1, MPI_CHAR, 0, MPI_COMM_WORLD);
 
     // Determine chunk assignment for each process
-    int start, length;
+    int chunk_start, chunk_len;
     if (rank == 0) {
-        compute_chunk_info(rank, size, text_len, pattern_len, &start, &length);
+        compute_chunk_info(rank, size, text_len, pattern_len, &chunk_start, &chunk_len);
         send_chunk_info(size, text_len, pattern_len);
     } else {
-        receive_chunk_info(&start, &length);
+        receive_chunk_info(&chunk_start, &chunk_len);
     }
 
     // Extract the relevant text chunk
-    char* chunk = (char*)malloc(length + 1);
-    extract_chunk(chunk, text, start, length);
+    char* chunk = (char*)malloc(chunk_len + 1);
+    extract_chunk(chunk, text, chunk_start, chunk_len);
+    if (rank != 0) free(text);
+
+    *start = chunk_start;
+    *length = (int)strlen(chunk); // strncpy stops early if the overlap runs past the text end
+    *owned = (rank == size - 1) ? *length : text_len / size;
+    return chunk;
+}
+
+/**
+ * File distribution: each process reads only its own chunk plus the
+ * pattern_len - 1 byte overlap with collective MPI-IO, so memory per process
+ * is O(text size / p) and the text never passes through the master.
+ */
+char* distribute_from_file(const char* path, int pattern_len, int rank, int size, long long* start, int* length, int* owned) {
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Offset text_len;
+    MPI_File_get_size(fh, &text_len);
+
+    long long chunk_size = text_len / size;
+    long long chunk_start = rank * chunk_size;
+    long long chunk_len = (rank == size - 1) ? text_len - chunk_start : chunk_size + pattern_len - 1;
+    if (chunk_start + chunk_len > text_len) chunk_len = text_len - chunk_start;
+    if (chunk_len > INT_MAX) {
+        if (rank == 0) fprintf(stderr, "Error: chunks larger than 2 GiB are not supported, use more processes.\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    char* chunk = (char*)malloc(chunk_len + 1);
+    MPI_File_read_at_all(fh, chunk_start, chunk, (int)chunk_len, MPI_CHAR, MPI_STATUS_IGNORE);
+    chunk[chunk_len] = '\0';
+    MPI_File_close(&fh);
+
+    *start = chunk_start;
+    *length = (int)chunk_len;
+    *owned = (rank == size - 1) ? (int)chunk_len : (int)chunk_size;
+    return chunk;
+}
+
+/*
+ * Search engines. Every engine reports all match positions of the pattern in
+ * text[0..n) in increasing order through a callback, which returns nonzero to
+ * stop the scan early (e.g. after the first match).
+ */
+typedef int (*MatchCallback)(int pos, void* ctx);
+
+typedef struct {
+    const unsigned char* pat;
+    int len;
+    int shift[UCHAR_MAX + 1];   // Horspool bad-character shifts
+    int crit;                   // Two-Way critical factorization position
+    int period;                 // Two-Way period of the right half
+    int periodic;               // Nonzero if the pattern is periodic (Two-Way memory is used)
+} Matcher;
+
+typedef void (*EngineFn)(const Matcher* m, const unsigned char* text, int n, MatchCallback cb, void* ctx);
+
+// Engine ids, also used as indexes of engine_names / engine_fns
+#define ENGINE_AUTO -1
+#define ENGINE_NAIVE 0
+#define ENGINE_HORSPOOL 1
+#define ENGINE_TWOWAY 2
+#define ENGINE_SIMD 3
+#define NUM_ENGINES 4
+
+// Brute force: compare the pattern at every offset
+void search_naive(const Matcher* m, const unsigned char* text, int n, MatchCallback cb, void* ctx) {
+    for (int i = 0; i <= n - m->len; i++) {
+        if (memcmp(text + i, m->pat, m->len) == 0 && cb(i, ctx)) return;
+    }
+}
+
+// Boyer-Moore-Horspool: shift by the bad-character rule on the last window byte
+void search_horspool(const Matcher* m, const unsigned char* text, int n, MatchCallback cb, void* ctx) {
+    const unsigned char last = m->pat[m->len - 1];
+    int j = 0;
+    while (j <= n - m->len) {
+        unsigned char c = text[j + m->len - 1];
+        if (c == last && memcmp(text + j, m->pat, m->len - 1) == 0 && cb(j, ctx)) return;
+        j += m->shift[c];
+    }
+}
+
+/**
+ * Crochemore-Perrin Two-Way: compares the right half of the critical
+ * factorization left to right, then the left half right to left. Runs in
+ * O(n) time with O(1) extra space whatever the pattern or text.
+ */
+void search_twoway(const Matcher* m, const unsigned char* text, int n, MatchCallback cb, void* ctx) {
+    const unsigned char* x = m->pat;
+    int len = m->len, ell = m->crit;
+    int j = 0;
+
+    if (m->periodic) {
+        int memory = -1;  // Prefix of the pattern already known to match
+        while (j <= n - len) {
+            int i = (ell > memory ? ell : memory) + 1;
+            while (i < len && x[i] == text[i + j]) i++;
+            if (i >= len) {
+                i = ell;
+                while (i > memory && x[i] == text[i + j]) i--;
+                if (i <= memory && cb(j, ctx)) return;
+                j += m->period;
+                memory = len - m->period - 1;
+            } else {
+                j += i - ell;
+                memory = -1;
+            }
+        }
+    } else {
+        while (j <= n - len) {
+            int i = ell + 1;
+            while (i < len && x[i] == text[i + j]) i++;
+            if (i >= len) {
+                i = ell;
+                while (i >= 0 && x[i] == text[i + j]) i--;
+                if (i < 0 && cb(j, ctx)) return;
+                j += m->period;
+            } else {
+                j += i - ell;
+            }
+        }
+    }
+}
+
+/**
+ * First/last-byte filter: tests 32 candidate positions at a time by comparing
+ * the first and the last pattern bytes with AVX2, then verifies only the
+ * surviving candidates. Without AVX2 the same filter runs one byte at a time.
+ */
+void search_simd(const Matcher* m, const unsigned char* text, int n, MatchCallback cb, void* ctx) {
+    const int len = m->len;
+    const unsigned char first = m->pat[0], last = m->pat[len - 1];
+    int i = 0;
+
+#ifdef __AVX2__
+    const __m256i vfirst = _mm256_set1_epi8((char)first);
+    const __m256i vlast = _mm256_set1_epi8((char)last);
+    for (; i + len - 1 + 32 <= n; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i*)(text + i + len - 1));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(vfirst, block_first),
+                                      _mm256_cmpeq_epi8(vlast, block_last));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(eq);
+        while (mask) {
+            int pos = i + __builtin_ctz(mask);
+            if ((len <= 2 || memcmp(text + pos + 1, m->pat + 1, len - 2) == 0) && cb(pos, ctx)) return;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // Scalar tail (or the whole text without AVX2)
+    for (; i <= n - len; i++) {
+        if (text[i] == first && text[i + len - 1] == last &&
+            (len <= 2 || memcmp(text + i + 1, m->pat + 1, len - 2) == 0) && cb(i, ctx)) return;
+    }
+}
+
+const char* engine_names[NUM_ENGINES] = {"naive", "horspool", "twoway", "simd"};
+EngineFn engine_fns[NUM_ENGINES] = {search_naive, search_horspool, search_twoway, search_simd};
+
+/**
+ * Automatic engine choice from the pattern length. The SIMD filter is the
+ * fastest engine for short and medium patterns on both small and large
+ * alphabets; without AVX2, Horspool's shifts take over. Very long patterns
+ * use Two-Way, whose linear worst case matters most on repetitive input.
+ */
+int choose_engine(int pattern_len) {
+    if (pattern_len > 1024) return ENGINE_TWOWAY;
+#ifdef __AVX2__
+    return ENGINE_SIMD;
+#else
+    return pattern_len < 4 ? ENGINE_SIMD : ENGINE_HORSPOOL;
+#endif
+}
+
+int parse_engine(const char* name) {
+    if (strcmp(name, "auto") == 0) return ENGINE_AUTO;
+    for (int e = 0; e < NUM_ENGINES; e++) {
+        if (strcmp(name, engine_names[e]) == 0) return e;
+    }
+    return -2;
+}
+
+/**
+ * Maximal suffix of x under the byte order (reverse = 0) or its reverse
+ * (reverse = 1). Returns the position before the suffix and stores its period.
+ */
+int maximal_suffix(const unsigned char* x, int len, int reverse, int* period) {
+    int ms = -1, j = 0, k = 1, p = 1;
+    while (j + k < len) {
+        unsigned char a = x[j + k], b = x[ms + k];
+        if (reverse ? a > b : a < b) {
+            j += k;
+            k = 1;
+            p = j - ms;
+        } else if (a == b) {
+            if (k != p) {
+                k++;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            ms = j++;
+            k = p = 1;
+        }
+    }
+    *period = p;
+    return ms;
+}
+
+// Precomputes the tables of every engine for the given pattern
+void init_matcher(Matcher* m, const char* pattern, int pattern_len) {
+    m->pat = (const unsigned char*)pattern;
+    m->len = pattern_len;
+
+    for (int c = 0; c <= UCHAR_MAX; c++) m->shift[c] = pattern_len;
+    for (int i = 0; i < pattern_len - 1; i++) m->shift[m->pat[i]] = pattern_len - 1 - i;
+
+    int p, q;
+    int i = maximal_suffix(m->pat, pattern_len, 0, &p);
+    int j = maximal_suffix(m->pat, pattern_len, 1, &q);
+    m->crit = i > j ? i : j;
+    m->period = i > j ? p : q;
+    m->periodic = memcmp(m->pat, m->pat + m->period, m->crit + 1) == 0;
+    if (!m->periodic) {
+        int left = m->crit + 1, right = pattern_len - m->crit - 1;
+        m->period = (left > right ? left : right) + 1;
+    }
+}
+
+// Callback for first-match search: remember the position and stop
+int stop_at_first(int pos, void* ctx) {
+    *(int*)ctx = pos;
+    return 1;
+}
+
+// Callback for benchmarks: count every match
+int count_match(int pos, void* ctx) {
+    (void)pos;
+    (*(long*)ctx)++;
+    return 0;
+}
+
+/**
+ * String matching within a chunk with the selected engine.
+ * Returns the offset of the first match, or -1 if there is none.
+ */
+int find_first(EngineFn engine, const Matcher* m, const char* chunk, int length) {
+    int pos = -1;
+    engine(m, (const unsigned char*)chunk, length, stop_at_first, &pos);
+    return pos;
+}
+
+/*
+ * Aho-Corasick automaton for multi-pattern search. Bytes that occur in no
+ * pattern share class 0, so the transition table is a dense
+ * num_states x num_classes array of int32 that stays small and cache friendly.
+ */
+typedef struct {
+    int num_states;
+    int num_classes;
+    int num_patterns;
+    int max_len;
+    unsigned char class_map[UCHAR_MAX + 1];
+    int* delta;       // delta[s * num_classes + c]: next state
+    int* term;        // Pattern ending exactly in state s, -1 if none
+    int* dict;        // Nearest proper suffix state with a pattern, 0 if none
+    int* out;         // s itself if term[s] >= 0, else dict[s]
+    int* pat_len;     // Length of every pattern
+    int* dup_next;    // Next pattern with the same text (duplicate lines), -1 if none
+} AhoCorasick;
+
+/**
+ * Reads one pattern per line (trailing '\r' and empty lines are ignored).
+ * Returns the number of patterns; *buffer holds them NUL-separated.
+ */
+int read_patterns(const char* path, char** buffer, char*** patterns) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    fseek(file, 0, SEEK_END);
+    long fsize = ftell(file);
+    rewind(file);
+
+    char* buf = (char*)malloc(fsize + 1);
+    if (fread(buf, 1, fsize, file) != (size_t)fsize) {
+        fprintf(stderr, "Error: cannot read %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    buf[fsize] = '\n';
+    fclose(file);
+
+    int count = 0, capacity = 64;
+    char** list = (char**)malloc(capacity * sizeof(char*));
+    char* line = buf;
+    for (long i = 0; i <= fsize; i++) {
+        if (buf[i] != '\n') continue;
+        buf[i] = '\0';
+        if (i > 0 && buf[i - 1] == '\r' && &buf[i - 1] >= line) buf[i - 1] = '\0';
+        if (line[0] != '\0') {
+            if (count == capacity) {
+                capacity *= 2;
+                list = (char**)realloc(list, capacity * sizeof(char*));
+            }
+            list[count++] = line;
+        }
+        line = buf + i + 1;
+    }
+
+    *buffer = buf;
+    *patterns = list;
+    return count;
+}
+
+void alloc_automaton(AhoCorasick* ac) {
+    ac->delta = (int*)malloc((size_t)ac->num_states * ac->num_classes * sizeof(int));
+    ac->term = (int*)malloc(ac->num_states * sizeof(int));
+    ac->dict = (int*)malloc(ac->num_states * sizeof(int));
+    ac->out = (int*)malloc(ac->num_states * sizeof(int));
+    ac->pat_len = (int*)malloc(ac->num_patterns * sizeof(int));
+    ac->dup_next = (int*)malloc(ac->num_patterns * sizeof(int));
+}
+
+void free_automaton(AhoCorasick* ac) {
+    free(ac->delta);
+    free(ac->term);
+    free(ac->dict);
+    free(ac->out);
+    free(ac->pat_len);
+    free(ac->dup_next);
+}
+
+/**
+ * Builds the automaton: a trie over the byte classes, then a BFS that fills
+ * the missing transitions from the failure links, turning the trie into a
+ * complete DFA so the scan does exactly one table lookup per text byte.
+ */
+void build_automaton(AhoCorasick* ac, char** patterns, int num_patterns) {
+    int total_len = 0;
+    memset(ac->class_map, 0, sizeof(ac->class_map));
+    ac->num_classes = 1;
+    ac->max_len = 0;
+    for (int p = 0; p < num_patterns; p++) {
+        int len = strlen(patterns[p]);
+        total_len += len;
+        if (len > ac->max_len) ac->max_len = len;
+        for (int i = 0; i < len; i++) {
+            unsigned char b = patterns[p][i];
+            if (ac->class_map[b] == 0) ac->class_map[b] = ac->num_classes++;
+        }
+    }
+
+    ac->num_patterns = num_patterns;
+    ac->num_states = total_len + 1;  // Upper bound, trimmed below
+    alloc_automaton(ac);
+    const int k = ac->num_classes;
+    memset(ac->delta, -1, (size_t)ac->num_states * k * sizeof(int));
+    memset(ac->term, -1, ac->num_states * sizeof(int));
+
+    // Trie construction
+    int used = 1;
+    for (int p = 0; p < num_patterns; p++) {
+        int s = 0;
+        ac->pat_len[p] = strlen(patterns[p]);
+        for (int i = 0; i < ac->pat_len[p]; i++) {
+            int c = ac->class_map[(unsigned char)patterns[p][i]];
+            if (ac->delta[s * k + c] == -1) ac->delta[s * k + c] = used++;
+            s = ac->delta[s * k + c];
+        }
+        ac->dup_next[p] = ac->term[s];
+        ac->term[s] = p;
+    }
+    ac->num_states = used;
+
+    // BFS over the trie: failure links become table entries
+    int* fail = (int*)malloc(used * sizeof(int));
+    int* queue = (int*)malloc(used * sizeof(int));
+    int head = 0, tail = 0;
+    fail[0] = 0;
+    ac->dict[0] = 0;
+    ac->out[0] = 0;
+    for (int c = 0; c < k; c++) {
+        int t = ac->delta[c];
+        if (t == -1) {
+            ac->delta[c] = 0;
+        } else {
+            fail[t] = 0;
+            queue[tail++] = t;
+        }
+    }
+    while (head < tail) {
+        int s = queue[head++];
+        ac->dict[s] = ac->term[fail[s]] >= 0 ? fail[s] : ac->dict[fail[s]];
+        ac->out[s] = ac->term[s] >= 0 ? s : ac->dict[s];
+        for (int c = 0; c < k; c++) {
+            int t = ac->delta[s * k + c];
+            if (t == -1) {
+                ac->delta[s * k + c] = ac->delta[fail[s] * k + c];
+            } else {
+                fail[t] = ac->delta[fail[s] * k + c];
+                queue[tail++] = t;
+            }
+        }
+    }
+    free(fail);
+    free(queue);
+}
+
+/**
+ * Broadcasts the compiled automaton from the master process, so workers never
+ * see the pattern file or repeat the construction.
+ */
+void broadcast_automaton(AhoCorasick* ac, int rank) {
+    int header[4] = {ac->num_states, ac->num_classes, ac->num_patterns, ac->max_len};
+    MPI_Bcast(header, 4, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+        ac->num_states = header[0];
+        ac->num_classes = header[1];
+        ac->num_patterns = header[2];
+        ac->max_len = header[3];
+        alloc_automaton(ac);
+    }
+    MPI_Bcast(ac->class_map, UCHAR_MAX + 1, MPI_UNSIGNED_CHAR, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->delta, ac->num_states * ac->num_classes, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->term, ac->num_states, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->dict, ac->num_states, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->out, ac->num_states, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->pat_len, ac->num_patterns, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(ac->dup_next, ac->num_patterns, MPI_INT, 0, MPI_COMM_WORLD);
+}
+
+/**
+ * Single pass over the chunk. A match is counted only if it starts in the
+ * first 'owned' positions, so matches in the overlap are not counted twice.
+ */
+void scan_automaton(const AhoCorasick* ac, const char* chunk, int length, int owned, long long* counts) {
+    const int k = ac->num_classes;
+    int s = 0;
+    for (int i = 0; i < length; i++) {
+        s = ac->delta[s * k + ac->class_map[(unsigned char)chunk[i]]];
+        for (int t = ac->out[s]; t != 0; t = ac->dict[t]) {
+            for (int p = ac->term[t]; p >= 0; p = ac->dup_next[p]) {
+                if (i - ac->pat_len[p] + 1 < owned) counts[p]++;
+            }
+        }
+    }
+}
+
+/**
+ * Fills text with either English-like words (natural language) or a uniform
+ * ACGT sequence (DNA-like alphabet), deterministically from the seed.
+ */
+void generate_text(char* text, long n, int dna, unsigned int seed) {
+    static const char* words[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with",
+        "be", "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which",
+        "but", "have", "an", "had", "they", "you", "were", "their", "one", "all", "we",
+        "parallel", "process", "message", "memory", "search", "pattern", "string", "matching"
+    };
+    const int num_words = sizeof(words) / sizeof(words[0]);
+    srand(seed);
+    long i = 0;
+    while (i < n) {
+        if (dna) {
+            text[i++] = "ACGT"[rand() % 4];
+        } else {
+            const char* w = words[rand() % num_words];
+            while (*w && i < n) text[i++] = *w++;
+            if (i < n) text[i++] = (rand() % 12 == 0) ? '.' : ' ';
+        }
+    }
+}
+
+/**
+ * Benchmark mode (single process): measures the throughput of every engine on
+ * natural-language and DNA-like texts for several pattern lengths. Patterns
+ * are taken from the text so every engine has matches to verify.
+ */
+void run_benchmark(long text_mb) {
+    const int pattern_lens[] = {4, 16, 64, 256};
+    const int num_lens = sizeof(pattern_lens) / sizeof(pattern_lens[0]);
+    const int repeats = 3;
+    long n = text_mb * 1024 * 1024;
+    if (n > INT_MAX - 1) n = INT_MAX - 1;
+    char* text = (char*)malloc(n);
+
+    printf("%-9s %8s %-9s %10s %10s %8s\n", "alphabet", "pat_len", "engine", "matches", "GB/s", "auto");
+    for (int dna = 0; dna <= 1; dna++) {
+        generate_text(text, n, dna, 42);
+        for (int l = 0; l < num_lens; l++) {
+            int m_len = pattern_lens[l];
+            char* pattern = (char*)malloc(m_len + 1);
+            memcpy(pattern, text + n / 2, m_len);
+            pattern[m_len] = '\0';
+
+            Matcher m;
+            init_matcher(&m, pattern, m_len);
+            for (int e = 0; e < NUM_ENGINES; e++) {
+                long matches = 0;
+                double best = 1e30;
+                for (int r = 0; r < repeats; r++) {
+                    matches = 0;
+                    double t0 = MPI_Wtime();
+                    engine_fns[e](&m, (const unsigned char*)text, (int)n, count_match, &matches);
+                    double t = MPI_Wtime() - t0;
+                    if (t < best) best = t;
+                }
+                printf("%-9s %8d %-9s %10ld %10.3f %8s\n", dna ? "dna" : "english", m_len,
+                       engine_names[e], matches, n / best / 1e9, choose_engine(m_len) == e ? "*" : "");
+            }
+            free(pattern);
+        }
+    }
+    free(text);
+}
+
+// Generator mode (master process only): writes text_mb MiB of English-like text to path
+void write_text_file(const char* path, long text_mb) {
+    long n = text_mb * 1024 * 1024;
+    char* text = (char*)malloc(n);
+    generate_text(text, n, 0, 42);
+    FILE* fp = fopen(path, "wb");
+    if (!fp || fwrite(text, 1, n, fp) != (size_t)n) {
+        fprintf(stderr, "Error: cannot write %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    fclose(fp);
+    free(text);
+}
+
+/**
+ * First-match search with cooperative early termination. Rank 0 exposes the
+ * best match known so far in an RMA window. Every process scans its chunk in
+ * blocks of SCAN_BLOCK positions, publishes a match with an atomic MIN and
+ * stops as soon as its next block starts past the global best, since nothing
+ * it could still find would be earlier. A final MPI_Allreduce keeps the
+ * earliest match.
+ */
+void run_first_match(int engine, const Matcher* matcher, const char* chunk, long long start, int length, int rank) {
+    long long* best_slot;
+    MPI_Win best_win;
+    MPI_Win_allocate(rank == 0 ? sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &best_slot, &best_win);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, best_win);
+        *best_slot = LLONG_MAX;
+        MPI_Win_unlock(0, best_win);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, best_win);
 
     /**
-     * Perform naive string matching within the assigned chunk.
-     * Initialize match_index with INT_MAX to serve as sentinel for 'no match'.
+     * Perform string matching within the assigned chunk, one block at a time.
+     * Initialize match_index with LLONG_MAX to serve as sentinel for 'no match'.
      */
-    int match_index = INT_MAX;
-    for (int i = 0; i <= length - pattern_len; i++) {
-        if (strncmp(&chunk[i], pattern, pattern_len) == 0) {
-            match_index = start + i;
+    long long match_index = LLONG_MAX;
+    long long global_best = LLONG_MAX;
+    for (int block = 0; block <= length - matcher->len; block += SCAN_BLOCK) {
+        if (start + block >= global_best) break;  // An earlier match is already known
+
+        int block_len = length - block;
+        if (block_len > SCAN_BLOCK + matcher->len - 1) block_len = SCAN_BLOCK + matcher->len - 1;
+        int offset = find_first(engine_fns[engine], matcher, chunk + block, block_len);
+        if (offset >= 0) {
+            match_index = start + block + offset;
+            long long previous;
+            MPI_Fetch_and_op(&match_index, &previous, MPI_LONG_LONG, 0, 0, MPI_MIN, best_win);
+            MPI_Win_flush(0, best_win);
             break;
         }
+
+        MPI_Fetch_and_op(NULL, &global_best, MPI_LONG_LONG, 0, 0, MPI_NO_OP, best_win);
+        MPI_Win_flush(0, best_win);
     }
 
+    MPI_Win_unlock_all(best_win);
+    MPI_Win_free(&best_win);
+
     /**
      * Use MPI_Allreduce with MPI_MIN to find the global earliest match.
-     * If no match was found in any process, INT_MAX is preserved.
+     * If no match was found in any process, LLONG_MAX is preserved.
      */
-    int global_match_index;
-    MPI_Allreduce(&match_index, &global_match_index, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    long long global_match_index;
+    MPI_Allreduce(&match_index, &global_match_index, 1, MPI_LONG_LONG, MPI_MIN, MPI_COMM_WORLD);
 
     // If this process found the earliest match, it prints the result
-    if (match_index == global_match_index && global_match_index != INT_MAX) {
-        printf("First match found by process %d at index %d\n", rank, match_index);
+    if (match_index == global_match_index && global_match_index != LLONG_MAX) {
+        printf("First match found by process %d at index %lld\n", rank, match_index);
     }
 
     // If no match was found, master process prints message
-    if (global_match_index == INT_MAX && rank == 0) {
+    if (global_match_index == LLONG_MAX && rank == 0) {
         printf("No match found in the text.\n");
     }
+}
+
+// Growable buffer of global match positions for the all-matches mode
+typedef struct {
+    long long* pos;
+    int len, cap;
+    long long start;   // Global offset of the chunk
+    int owned;         // Matches starting at or after this chunk offset belong to the next process
+} MatchBuffer;
+
+// Callback for all-matches search: append owned matches, stop at the overlap
+int collect_match(int pos, void* ctx) {
+    MatchBuffer* buf = (MatchBuffer*)ctx;
+    if (pos >= buf->owned) return 1;
+    if (buf->len == buf->cap) {
+        buf->cap *= 2;
+        buf->pos = (long long*)realloc(buf->pos, buf->cap * sizeof(long long));
+    }
+    buf->pos[buf->len++] = buf->start + pos;
+    return 0;
+}
+
+/**
+ * All-matches search: every process collects all (possibly overlapping) matches
+ * starting in its own part of the text, MPI_Exscan turns the local output sizes
+ * into file offsets, and all processes write their part in global order with
+ * collective MPI-IO. No process ever holds more than its own matches.
+ * Binary output is one native 64-bit integer per match, text output one decimal per line.
+ */
+void run_all_matches(int engine, const Matcher* matcher, const char* chunk, long long start, int length,
+                     int owned, const char* out_path, int binary, int rank) {
+    MatchBuffer buf;
+    buf.cap = 1024;
+    buf.len = 0;
+    buf.pos = (long long*)malloc(buf.cap * sizeof(long long));
+    buf.start = start;
+    buf.owned = owned;
+    engine_fns[engine](matcher, (const unsigned char*)chunk, length, collect_match, &buf);
+
+    // Serialize the local matches
+    char* out;
+    long long out_bytes;
+    if (binary) {
+        out = (char*)buf.pos;
+        out_bytes = (long long)buf.len * sizeof(long long);
+    } else {
+        out = (char*)malloc((size_t)buf.len * 21 + 1);  // Up to 20 digits and a newline each
+        out_bytes = 0;
+        for (int i = 0; i < buf.len; i++) {
+            out_bytes += sprintf(out + out_bytes, "%lld\n", buf.pos[i]);
+        }
+    }
+    if (out_bytes > INT_MAX) {
+        fprintf(stderr, "Error: process %d has more than 2 GiB of matches to write.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Offset of this process' output = total output size of all lower ranks
+    long long offset = 0, totals[2], local[2] = {buf.len, out_bytes};
+    MPI_Exscan(&out_bytes, &offset, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) offset = 0;  // MPI_Exscan leaves rank 0's result undefined
+    MPI_Allreduce(local, totals, 2, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, out_path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", out_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, totals[1]);  // Drop leftovers of an older, longer file
+    MPI_File_write_at_all(fh, offset, out, (int)out_bytes, MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    if (rank == 0) {
+        printf("%lld matches written to %s (%s)\n", totals[0], out_path, binary ? "binary" : "text");
+    }
+
+    if (!binary) free(out);
+    free(buf.pos);
+}
+
+/**
+ * Multi-pattern search: every process runs the broadcast automaton over its
+ * chunk once and the per-pattern counts are summed on the master process.
+ */
+void run_multi_pattern(const AhoCorasick* ac, char** patterns, const char* chunk, int length, int owned, int rank) {
+    long long* counts = (long long*)calloc(ac->num_patterns, sizeof(long long));
+    long long* totals = (rank == 0) ? (long long*)malloc(ac->num_patterns * sizeof(long long)) : NULL;
+
+    scan_automaton(ac, chunk, length, owned, counts);
+    MPI_Reduce(counts, totals, ac->num_patterns, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        long long total = 0;
+        printf("Matches per pattern:\n");
+        for (int p = 0; p < ac->num_patterns; p++) {
+            printf("%s: %lld\n", patterns[p], totals[p]);
+            total += totals[p];
+        }
+        printf("Total: %lld matches of %d patterns (%d automaton states, %d byte classes)\n",
+               total, ac->num_patterns, ac->num_states, ac->num_classes);
+        free(totals);
+    }
+    free(counts);
+}
+
+/**
+ * Entry point: performs parallel string matching using the selected engine,
+ * or the Aho-Corasick automaton when a pattern file is given.
+ * Distributes the workload among MPI processes and finds the earliest match
+ * (or writes every match with -a).
+ */
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);   // Get current process rank
+    MPI_Comm_size(MPI_COMM_WORLD, &size);   // Get total number of processes
+
+    char* text = NULL;
+    char* path = NULL;
+    char* pattern = NULL;
+    char* pattern_file = NULL;
+    char* out_path = NULL;
+    int from_file = 0;
+    int binary = 0;
+    int multi = 0;
+    int engine = ENGINE_AUTO;
+
+    // Benchmark mode: every engine on synthetic texts, run by the master process only
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        if (rank == 0) run_benchmark(argc > 2 ? atol(argv[2]) : 64);
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Generator mode: -g <file> <text_mb> writes a synthetic text for -f runs
+    if (argc == 4 && strcmp(argv[1], "-g") == 0) {
+        if (rank == 0) write_text_file(argv[2], atol(argv[3]));
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Master process parses input arguments: options first, then the positional text/pattern
+    if (rank == 0) {
+        int argi = 1, valid = 1;
+        while (argi + 1 < argc && argv[argi][0] == '-') {
+            if (strcmp(argv[argi], "-b") == 0) {
+                binary = 1;
+                argi++;
+                continue;
+            }
+            if (strcmp(argv[argi], "-e") == 0) {
+                engine = parse_engine(argv[argi + 1]);
+                if (engine == -2) valid = 0;
+            } else if (strcmp(argv[argi], "-f") == 0) {
+                from_file = 1;
+                path = argv[argi + 1];
+            } else if (strcmp(argv[argi], "-P") == 0) {
+                multi = 1;
+                pattern_file = argv[argi + 1];
+            } else if (strcmp(argv[argi], "-a") == 0) {
+                out_path = argv[argi + 1];
+            } else {
+                valid = 0;
+            }
+            argi += 2;
+        }
+        if (argc - argi != !from_file + !multi || (multi && out_path)) valid = 0;
+        if (valid && !from_file) text = argv[argi++];
+        if (valid && !multi) pattern = argv[argi++];
+        if (!valid || (!multi && pattern[0] == '\0')) {
+            fprintf(stderr, "Usage: %s [-e engine] <text> <pattern>\n", argv[0]);
+            fprintf(stderr, "       %s [-e engine] -f <text_file> <pattern>\n", argv[0]);
+            fprintf(stderr, "       %s [-e engine] -a <output_file> [-b] [-f <text_file> | <text>] <pattern>\n", argv[0]);
+            fprintf(stderr, "       %s -P <pattern_file> [-f <text_file> | <text>]\n", argv[0]);
+            fprintf(stderr, "       %s --bench [text_mb]\n", argv[0]);
+            fprintf(stderr, "       %s -g <file> <text_mb>\n", argv[0]);
+            fprintf(stderr, "Engines: auto (default), naive, horspool, twoway, simd\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    // Broadcast the options to all processes
+    MPI_Bcast(&from_file, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&multi, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&engine, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&binary, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    int all_matches = (rank == 0) ? out_path != NULL : 0;
+    MPI_Bcast(&all_matches, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Either a single pattern (broadcast as a string) or a compiled automaton
+    int pattern_len;
+    Matcher matcher;
+    AhoCorasick ac;
+    char* pattern_buf = NULL;
+    char** patterns = NULL;
+    if (multi) {
+        if (rank == 0) {
+            int num_patterns = read_patterns(pattern_file, &pattern_buf, &patterns);
+            if (num_patterns == 0) {
+                fprintf(stderr, "Error: %s contains no patterns\n", pattern_file);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            build_automaton(&ac, patterns, num_patterns);
+        }
+        broadcast_automaton(&ac, rank);
+        pattern_len = ac.max_len;  // Chunk overlap is set by the longest pattern
+    } else {
+        pattern = broadcast_string(pattern, rank);
+        pattern_len = strlen(pattern);
+        if (engine == ENGINE_AUTO) engine = choose_engine(pattern_len);
+        init_matcher(&matcher, pattern, pattern_len);
+    }
+
+    // Distribute the text: every process ends up with its own overlapping chunk
+    long long start;
+    int length, owned;
+    char* chunk;
+    if (from_file) {
+        path = broadcast_string(path, rank);
+        chunk = distribute_from_file(path, pattern_len, rank, size, &start, &length, &owned);
+    } else {
+        chunk = distribute_by_broadcast(text, pattern_len, rank, size, &start, &length, &owned);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    if (multi) {
+        run_multi_pattern(&ac, patterns, chunk, length, owned, rank);
+    } else if (all_matches) {
+        out_path = broadcast_string(out_path, rank);
+        run_all_matches(engine, &matcher, chunk, start, length, owned, out_path, binary, rank);
+        if (rank != 0) free(out_path);
+    } else {
+        run_first_match(engine, &matcher, chunk, start, length, rank);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) printf("Execution time: %.6f seconds\n", MPI_Wtime() - start_time);
 
     // Cleanup dynamic memory allocations
     free(chunk);
-    if (rank != 0) {
+    if (multi) {
+        free_automaton(&ac);
+        free(pattern_buf);
+        free(patterns);
+    } else if (rank != 0) {
         free(pattern);
-        free(text);
     }
+    if (rank != 0 && from_file) free(path);
 
     MPI_Finalize();
     return 0;
@@ -0,0 +1,321 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: Hybrid MPI+OpenMP pi estimation with midpoint, Simpson and Gauss-Legendre rules, compensated summation and tolerance-driven refinement.
+ */
+
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PI_REFERENCE 3.14159265358979323846
+#define SUM_BLOCK 4096               // Terms summed in SIMD lanes before a compensated add
+#define INITIAL_INTERVALS 16         // Intervals of the first refinement level
+#define MAX_INTERVALS (1LL << 53)    // i + c is a double: above 2^53 the offset c is lost
+
+enum { RULE_MIDPOINT, RULE_SIMPSON, RULE_GAUSS };
+
+const char* rule_names[] = {"midpoint", "simpson", "gauss"};
+const int rule_orders[] = {2, 4, 8};  // Error of the composite rule falls as h^order
+const int rule_factors[] = {3, 2, 2}; // Interval growth per refinement level, chosen so the new points nest (not for Gauss)
+
+// 4-point Gauss-Legendre nodes and weights on [-1, 1]
+const double gauss_nodes[4] = {-0.8611363115940526, -0.3399810435848563, 0.3399810435848563, 0.8611363115940526};
+const double gauss_weights[4] = {0.3478548451374538, 0.6521451548625461, 0.6521451548625461, 0.3478548451374538};
+
+// Running sum with its compensation term
+typedef struct {
+    double sum;
+    double comp;
+} CompensatedSum;
+
+static inline double f(double x) {
+    return 4.0 / (1.0 + x * x);
+}
+
+// Neumaier's variant of Kahan summation: also correct when |x| > |sum|
+static inline void neumaier_add(CompensatedSum* acc, double x) {
+    double t = acc->sum + x;
+    if (fabs(acc->sum) >= fabs(x)) {
+        acc->comp += (acc->sum - t) + x;
+    } else {
+        acc->comp += (x - t) + acc->sum;
+    }
+    acc->sum = t;
+}
+
+// MPI user operation combining the compensated partial sums of different ranks
+void compensated_op(void* in, void* inout, int* len, MPI_Datatype* type) {
+    (void)type;
+    CompensatedSum* a = (CompensatedSum*)in;
+    CompensatedSum* b = (CompensatedSum*)inout;
+    for (int i = 0; i < *len; i++) {
+        CompensatedSum acc = b[i];
+        neumaier_add(&acc, a[i].sum);
+        neumaier_add(&acc, a[i].comp);
+        b[i] = acc;
+    }
+}
+
+/**
+ * Sum of f((i + c) h) over i in [first, last): the integrand on a grid of
+ * step h shifted by c h. Every rule is a weighted combination of such sums,
+ * so the loops below contain no rule logic and vectorize as they are.
+ * Compensated: each thread adds SIMD-summed blocks of SUM_BLOCK terms with
+ * Neumaier's algorithm, and the thread results are combined in thread
+ * order. Plain: one OpenMP + SIMD reduction, as in omp_pi_estimation.
+ */
+CompensatedSum local_sum(long long first, long long last, double h, double c, int compensated) {
+    CompensatedSum total = {0.0, 0.0};
+    if (!compensated) {
+        double sum = 0.0;
+        #pragma omp parallel for simd reduction(+:sum) schedule(static)
+        for (long long i = first; i < last; i++) sum += f((i + c) * h);
+        total.sum = sum;
+        return total;
+    }
+
+    int threads = omp_get_max_threads();
+    CompensatedSum* partial = (CompensatedSum*)calloc(threads, sizeof(CompensatedSum));
+    #pragma omp parallel
+    {
+        CompensatedSum mine = {0.0, 0.0};
+        #pragma omp for schedule(static)
+        for (long long b = first; b < last; b += SUM_BLOCK) {
+            long long end = last - b < SUM_BLOCK ? last : b + SUM_BLOCK;
+            double block = 0.0;
+            #pragma omp simd reduction(+:block)
+            for (long long i = b; i < end; i++) block += f((i + c) * h);
+            neumaier_add(&mine, block);
+        }
+        partial[omp_get_thread_num()] = mine;
+    }
+    for (int t = 0; t < threads; t++) {
+        neumaier_add(&total, partial[t].sum);
+        neumaier_add(&total, partial[t].comp);
+    }
+    free(partial);
+    return total;
+}
+
+/**
+ * Shifted grid sum over the global index range [lo, hi). Rank r takes its
+ * uneven share of the 64-bit range (no n * r product, so n can reach 2^53).
+ * Every rank needs the result to decide whether to refine, so the rank sums
+ * are combined with MPI_Allreduce: compensated pairs with a user-defined
+ * MPI_Op, plain sums with MPI_SUM.
+ */
+double grid_sum(long long lo, long long hi, double h, double c, int compensated, int rank, int size) {
+    long long n = hi - lo, base = n / size, extra = n % size;
+    long long first = lo + base * rank + (rank < extra ? rank : extra);
+    long long last = first + base + (rank < extra);
+
+    CompensatedSum local = local_sum(first, last, h, c, compensated), total;
+    if (compensated) {
+        MPI_Datatype pair_type;
+        MPI_Op pair_op;
+        MPI_Type_contiguous(2, MPI_DOUBLE, &pair_type);
+        MPI_Type_commit(&pair_type);
+        MPI_Op_create(compensated_op, 1, &pair_op);
+        MPI_Allreduce(&local, &total, 1, pair_type, pair_op, MPI_COMM_WORLD);
+        MPI_Op_free(&pair_op);
+        MPI_Type_free(&pair_type);
+    } else {
+        MPI_Allreduce(&local.sum, &total.sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        total.comp = 0.0;
+    }
+    return total.sum + total.comp;
+}
+
+/**
+ * Running sums of one refinement level with n intervals of width h = 1 / n:
+ * nodes = f(0) / 2 + f(h) + ... + f(1 - h) + f(1) / 2 (trapezoid weights) and
+ * midpoints = f(h / 2) + f(3h / 2) + ... Composite rules in terms of them:
+ *   midpoint M(n) = h midpoints
+ *   Simpson  S(n) = h (nodes + 2 midpoints) / 3, with 2n + 1 evaluations
+ * gauss holds the 4-point Gauss-Legendre result, whose nodes never nest.
+ */
+typedef struct {
+    long long n;
+    double nodes;
+    double midpoints;
+    double gauss;
+} Level;
+
+double level_estimate(int rule, const Level* level) {
+    double h = 1.0 / (double)level->n;
+    if (rule == RULE_MIDPOINT) return h * level->midpoints;
+    if (rule == RULE_SIMPSON) return h * (level->nodes + 2.0 * level->midpoints) / 3.0;
+    return level->gauss;
+}
+
+double gauss_legendre(long long n, int compensated, int rank, int size) {
+    double h = 1.0 / (double)n, sum = 0.0;
+    for (int k = 0; k < 4; k++) sum += gauss_weights[k] * grid_sum(0, n, h, 0.5 * (1.0 + gauss_nodes[k]), compensated, rank, size);
+    return 0.5 * h * sum;
+}
+
+// Level with n intervals computed from scratch
+Level first_level(int rule, long long n, int compensated, int rank, int size) {
+    double h = 1.0 / (double)n;
+    Level level = {n, 0.0, 0.0, 0.0};
+    if (rule == RULE_GAUSS) {
+        level.gauss = gauss_legendre(n, compensated, rank, size);
+        return level;
+    }
+    level.midpoints = grid_sum(0, n, h, 0.5, compensated, rank, size);
+    if (rule == RULE_SIMPSON) level.nodes = grid_sum(1, n, h, 0.0, compensated, rank, size) + 0.5 * (f(0.0) + f(1.0));
+    return level;
+}
+
+/**
+ * Next level, evaluating only the new points:
+ *   midpoint: 3n intervals. The old midpoints are the middle midpoints of
+ *     the thirds, so only the points at 1/6 and 5/6 of each old interval are
+ *     new (2n evaluations).
+ *   Simpson: 2n intervals. The old nodes and midpoints become the new nodes,
+ *     so only the 2n new midpoints are evaluated.
+ *   Gauss: 2n intervals from scratch (4 * 2n evaluations).
+ */
+Level refine_level(int rule, const Level* level, int compensated, int rank, int size) {
+    long long n = level->n;
+    double h = 1.0 / (double)n;
+    Level next = {n * rule_factors[rule], 0.0, 0.0, 0.0};
+    if (rule == RULE_MIDPOINT) {
+        next.midpoints = level->midpoints + grid_sum(0, n, h, 1.0 / 6.0, compensated, rank, size) +
+                         grid_sum(0, n, h, 5.0 / 6.0, compensated, rank, size);
+    } else if (rule == RULE_SIMPSON) {
+        next.nodes = level->nodes + level->midpoints;
+        next.midpoints = grid_sum(0, next.n, 1.0 / (double)next.n, 0.5, compensated, rank, size);
+    } else {
+        next.gauss = gauss_legendre(next.n, compensated, rank, size);
+    }
+    return next;
+}
+
+// Integrand evaluations of a rule with n intervals computed from scratch
+double evaluations(int rule, long long n) {
+    if (rule == RULE_MIDPOINT) return (double)n;
+    if (rule == RULE_SIMPSON) return 2.0 * n + 1.0;
+    return 4.0 * n;
+}
+
+/**
+ * Refines by rule_factors[rule] from INITIAL_INTERVALS until the error
+ * estimate |I(kn) - I(n)| / (k^order - 1) of the finer result (Richardson)
+ * meets the tolerance. Refinement also stops when the estimate no longer
+ * shrinks, i.e. rounding error dominates, or at MAX_INTERVALS. Midpoint and
+ * Simpson levels reuse every earlier evaluation, so their total work equals
+ * that of the final level alone; Gauss recomputes each level.
+ */
+void run_to_tolerance(int rule, double tolerance, int compensated, int rank, int size) {
+    double previous = 0.0, previous_error = INFINITY, start = MPI_Wtime();
+    double ratio = pow(rule_factors[rule], rule_orders[rule]) - 1.0;
+    const char* reason = "interval limit reached";
+
+    if (rank == 0) {
+        printf("%s rule, %s summation, tolerance %.1e, %d processes x %d threads\n", rule_names[rule],
+               compensated ? "compensated" : "plain", tolerance, size, omp_get_max_threads());
+        printf("%-20s | %-17s | %-10s | %-10s | %s\n", "intervals", "estimate", "est. error", "true error", "time (s)");
+    }
+    Level level;
+    double total_evaluations = 0.0;
+    for (int depth = 0;; depth++) {
+        double t_level = MPI_Wtime();
+        if (depth == 0) {
+            level = first_level(rule, INITIAL_INTERVALS, compensated, rank, size);
+            total_evaluations = evaluations(rule, level.n);
+        } else {
+            level = refine_level(rule, &level, compensated, rank, size);
+            total_evaluations += rule == RULE_GAUSS ? evaluations(rule, level.n)
+                                                    : evaluations(rule, level.n) - evaluations(rule, level.n / rule_factors[rule]);
+        }
+        double estimate = level_estimate(rule, &level);
+        t_level = MPI_Wtime() - t_level;
+
+        double error = depth == 0 ? INFINITY : fabs(estimate - previous) / ratio;
+        if (rank == 0) {
+            printf("%-20lld | %.15f | %-10.3e | %-10.3e | %.4f\n", level.n, estimate, error, fabs(estimate - PI_REFERENCE), t_level);
+        }
+        previous = estimate;
+        if (error <= tolerance) {
+            reason = "converged";
+            break;
+        }
+        if (depth >= 3 && error >= previous_error) {
+            reason = "error estimate stopped decreasing (rounding floor)";
+            break;
+        }
+        previous_error = error;
+        if (level.n > MAX_INTERVALS / rule_factors[rule]) break;
+    }
+
+    if (rank == 0) {
+        printf("Result: pi = %.15f (%s), true error %.3e\n", previous, reason, fabs(previous - PI_REFERENCE));
+        printf("Total: %.3e integrand evaluations\n", total_evaluations);
+        printf("Execution time: %.6f seconds\n", MPI_Wtime() - start);
+    }
+}
+
+void run_fixed(int rule, long long n, int compensated, int rank, int size) {
+    double start = MPI_Wtime();
+    Level level = first_level(rule, n, compensated, rank, size);
+    double pi = level_estimate(rule, &level);
+    double elapsed = MPI_Wtime() - start;
+    if (rank == 0) {
+        printf("%s rule, %s summation, %lld intervals, %d processes x %d threads\n", rule_names[rule],
+               compensated ? "compensated" : "plain", n, size, omp_get_max_threads());
+        printf("Approximate value of pi: %.15f (true error %.3e)\n", pi, fabs(pi - PI_REFERENCE));
+        printf("Throughput: %.3e integrand evaluations/s\n", evaluations(rule, n) / elapsed);
+        printf("Execution time: %.6f seconds\n", elapsed);
+    }
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s <midpoint|simpson|gauss> <tolerance> [plain]\n", prog);
+    printf("       %s <midpoint|simpson|gauss> -n <intervals> [plain]   (1 <= intervals <= 2^53)\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size, rule = -1;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    for (int r = 0; argc > 1 && r < 3; r++) {
+        if (strcmp(argv[1], rule_names[r]) == 0) rule = r;
+    }
+    int fixed = argc > 2 && strcmp(argv[2], "-n") == 0;
+    int args = fixed ? 4 : 3;
+    if (rule < 0 || (argc != args && argc != args + 1) || (argc == args + 1 && strcmp(argv[args], "plain") != 0)) {
+        if (rank == 0) print_usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    int compensated = argc == args;
+
+    if (fixed) {
+        long long n = atoll(argv[3]);
+        if (n < 1 || n > MAX_INTERVALS) {
+            if (rank == 0) printf("Error: intervals must be between 1 and 2^53.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        run_fixed(rule, n, compensated, rank, size);
+    } else {
+        double tolerance = atof(argv[2]);
+        if (!(tolerance > 0.0)) {
+            if (rank == 0) printf("Error: tolerance must be positive.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        run_to_tolerance(rule, tolerance, compensated, rank, size);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
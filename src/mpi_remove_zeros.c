@@ -1,74 +1,1000 @@
 /*
  * Author: canetizen
  * Created on Sun May 25 2025
- * Description: MPI implementation for removing zeros from an array.
+ * Description: MPI implementation for removing zeros from an array (stream compaction with exscan offsets).
  */
 
 #include <mpi.h>
+#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-int main(int argc, char** argv) {
-    int rank, size;
+#define MAX_PRINTED_PAIRS 20
+#define MAX_THREADS 256
+#define ENCODE_BLOCK 65536  // Values per encoded block; offsets within a block fit in 16 bits
 
-    const int n = 10;
-    int data[10] = {5, 4, 0, 0, 0, 1, 0, 0, 2, 0};
+// Nonzeros of one rank as structure-of-arrays: global indices and values
+typedef struct {
+    long long* index;
+    int* value;
+    long long count;
+} Compacted;
 
-    MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+// Writes the nonzeros of in[0, n) as global indices (first + i) and values; returns how many
+typedef long long (*CompressFn)(const int* in, long long n, long long first, long long* index, int* value, long long capacity);
 
-    if (rank == 0 && n % size != 0) {
-        printf("Error: Array size must be divisible by number of processes.\n");
-        MPI_Abort(MPI_COMM_WORLD, 1);
+// Original branchy loop: one data-dependent branch per element
+long long compress_scalar(const int* in, long long n, long long first, long long* index, int* value, long long capacity) {
+    (void)capacity;
+    long long out = 0;
+    for (long long i = 0; i < n; i++) {
+        if (in[i] != 0) {
+            index[out] = first + i;
+            value[out] = in[i];
+            out++;
+        }
+    }
+    return out;
+}
+
+// Always stores, advances the output only for nonzeros: no branch to mispredict
+long long compress_branchless(const int* in, long long n, long long first, long long* index, int* value, long long capacity) {
+    long long out = 0, i = 0;
+    // Unconditional stores need a free slot, so the last nonzeros take the branchy loop
+    for (; i < n && out < capacity; i++) {
+        index[out] = first + i;
+        value[out] = in[i];
+        out += in[i] != 0;
+    }
+    for (; i < n; i++) {
+        if (in[i] != 0) {
+            index[out] = first + i;
+            value[out] = in[i];
+            out++;
+        }
+    }
+    return out;
+}
+
+#ifdef __AVX2__
+// permute_table[mask] moves the lanes set in mask to the front, for _mm256_permutevar8x32_epi32
+int permute_table[256][8] __attribute__((aligned(32)));
+
+void init_permute_table(void) {
+    for (int mask = 0; mask < 256; mask++) {
+        int k = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            if (mask & (1 << lane)) permute_table[mask][k++] = lane;
+        }
+        while (k < 8) permute_table[mask][k++] = 0;
+    }
+}
+#else
+void init_permute_table(void) {}
+#endif
+
+/**
+ * AVX2 compaction: the nonzero mask of 8 values selects a permutation from a
+ * 256-entry table that packs the kept values and their positions to the front.
+ * All 8 lanes are stored and the output advances by popcount(mask), so a
+ * vector is only stored whole when 8 slots of capacity remain.
+ */
+long long compress_avx2(const int* in, long long n, long long first, long long* index, int* value, long long capacity) {
+    long long out = 0, i = 0;
+
+#ifdef __AVX2__
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i base = _mm256_set1_epi64x(first);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero))) & 0xFF;
+        if (mask == 0) continue;
+        if (out + 8 > capacity) {
+            for (int l = 0; l < 8; l++) {
+                if (in[i + l] != 0) {
+                    index[out] = first + i + l;
+                    value[out++] = in[i + l];
+                }
+            }
+            continue;
+        }
+        __m256i perm = _mm256_load_si256((const __m256i*)permute_table[mask]);
+        // Positions within the chunk fit in 32 bits (chunks hold at most INT_MAX values)
+        __m256i pos = _mm256_permutevar8x32_epi32(_mm256_add_epi32(lanes, _mm256_set1_epi32((int)i)), perm);
+        _mm256_storeu_si256((__m256i*)(value + out), _mm256_permutevar8x32_epi32(v, perm));
+        _mm256_storeu_si256((__m256i*)(index + out), _mm256_add_epi64(base, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pos))));
+        _mm256_storeu_si256((__m256i*)(index + out + 4), _mm256_add_epi64(base, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pos, 1))));
+        out += __builtin_popcount(mask);
+    }
+#endif
+
+    // Scalar tail (or the whole chunk without AVX2)
+    return out + compress_scalar(in + i, n - i, first + i, index + out, value + out, capacity - out);
+}
+
+/**
+ * AVX-512 compaction with vpcompressd: 16 values per step, the compressed
+ * values and positions are written with masked stores, so nothing past the
+ * output is touched and the tail is a masked load. Falls back to AVX2.
+ */
+long long compress_avx512(const int* in, long long n, long long first, long long* index, int* value, long long capacity) {
+#ifdef __AVX512F__
+    long long out = 0;
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i base = _mm512_set1_epi64(first);
+    (void)capacity;
+    for (long long i = 0; i < n; i += 16) {
+        __mmask16 live = n - i >= 16 ? 0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi32(live, in + i);
+        __mmask16 mask = _mm512_test_epi32_mask(v, v);
+        if (mask == 0) continue;
+        int k = __builtin_popcount(mask);
+        __m512i pos = _mm512_maskz_compress_epi32(mask, _mm512_add_epi32(lanes, _mm512_set1_epi32((int)i)));
+        // maskz_compress + masked store is faster than compressstoreu on several cores
+        _mm512_mask_storeu_epi32(value + out, (__mmask16)((1u << k) - 1), _mm512_maskz_compress_epi32(mask, v));
+        _mm512_mask_storeu_epi64(index + out, (__mmask8)(k >= 8 ? 0xFF : (1u << k) - 1),
+                                 _mm512_add_epi64(base, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(pos))));
+        if (k > 8) {
+            _mm512_mask_storeu_epi64(index + out + 8, (__mmask8)((1u << (k - 8)) - 1),
+                                     _mm512_add_epi64(base, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(pos, 1))));
+        }
+        out += k;
+    }
+    return out;
+#else
+    return compress_avx2(in, n, first, index, value, capacity);
+#endif
+}
+
+// Engine ids, also used as indexes of engine_names / engine_fns
+enum { ENGINE_SCALAR, ENGINE_BRANCHLESS, ENGINE_AVX2, ENGINE_AVX512, NUM_ENGINES };
+const char* engine_names[NUM_ENGINES] = {"scalar", "branchless", "avx2", "avx512"};
+CompressFn engine_fns[NUM_ENGINES] = {compress_scalar, compress_branchless, compress_avx2, compress_avx512};
+
+// Widest kernel this build supports
+int best_engine(void) {
+#if defined(__AVX512F__)
+    return ENGINE_AVX512;
+#elif defined(__AVX2__)
+    return ENGINE_AVX2;
+#else
+    return ENGINE_BRANCHLESS;
+#endif
+}
+
+/**
+ * OpenMP compaction: every thread counts the nonzeros of its block, a prefix
+ * over the per-thread counts gives each thread its output offset, and then
+ * every thread compacts its block straight into the output. The output arrays
+ * are allocated to the exact size unless c already holds buffers.
+ */
+void compact_parallel(const int* chunk, long long count, long long first, CompressFn engine, Compacted* c) {
+    long long offsets[MAX_THREADS + 1];
+    int max_threads = omp_get_max_threads();
+    int num_threads = max_threads < MAX_THREADS ? max_threads : MAX_THREADS;
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        long long lo = count * t / nt, hi = count * (t + 1) / nt, nonzeros = 0;
+        for (long long i = lo; i < hi; i++) nonzeros += chunk[i] != 0;
+        offsets[t + 1] = nonzeros;
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            offsets[0] = 0;
+            for (int b = 1; b <= nt; b++) offsets[b] += offsets[b - 1];
+            c->count = offsets[nt];
+            if (c->index == NULL) {
+                c->index = (long long*)malloc((c->count > 0 ? c->count : 1) * sizeof(long long));
+                c->value = (int*)malloc((c->count > 0 ? c->count : 1) * sizeof(int));
+            }
+        }
+
+        engine(chunk + lo, hi - lo, first + lo, c->index + offsets[t], c->value + offsets[t], offsets[t + 1] - offsets[t]);
+    }
+}
+
+/**
+ * Encoded output for the gather path. A rank's chunk is cut into blocks of
+ * ENCODE_BLOCK values and every block is stored in whichever encoding of its
+ * nonzero positions is smallest, followed by the packed int32 values:
+ *   offsets: one uint16 offset per nonzero (2 bytes per nonzero)
+ *   bitmap:  one presence bit per element (ENCODE_BLOCK / 8 bytes)
+ *   rle:     LEB128 varint pairs (zero gap, nonzero run length) per run
+ * Density decides between offsets and bitmap, clustering (runs per nonzero)
+ * decides whether rle wins. The sizes are measured exactly before encoding.
+ */
+enum { ENC_OFFSETS, ENC_BITMAP, ENC_RLE, NUM_ENCODINGS };
+const char* encoding_names[NUM_ENCODINGS + 1] = {"offsets", "bitmap", "rle", "auto"};
+
+// Start of a rank's stream; blocks follow, each with a BlockHeader, positions (padded to 8 bytes) and values
+typedef struct {
+    long long first;
+    long long count;
+    long long nnz;
+    long long bytes;
+} StreamHeader;
+
+typedef struct {
+    unsigned int encoding;
+    unsigned int nnz;
+    unsigned int position_bytes;
+    unsigned int reserved;
+} BlockHeader;
+
+int varint_length(unsigned int v) {
+    int len = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        len++;
+    }
+    return len;
+}
+
+unsigned char* put_varint(unsigned char* p, unsigned int v) {
+    while (v >= 0x80) {
+        *p++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (unsigned char)v;
+    return p;
+}
+
+const unsigned char* get_varint(const unsigned char* p, unsigned int* v) {
+    unsigned int result = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        result |= (unsigned int)(*p++ & 0x7F) << shift;
+        shift += 7;
     }
+    *v = result | (unsigned int)*p++ << shift;
+    return p;
+}
+
+long long pad8(long long bytes) { return (bytes + 7) & ~7LL; }
+
+// Exact position bytes of every encoding, from the block's sorted nonzero positions
+void measure_block(const long long* pos, int nnz, int len, long long sizes[NUM_ENCODINGS]) {
+    long long rle = 0, prev_end = 0;
+    for (int j = 0; j < nnz;) {
+        int run = 1;
+        while (j + run < nnz && pos[j + run] == pos[j] + run) run++;
+        rle += varint_length((unsigned int)(pos[j] - prev_end)) + varint_length((unsigned int)run);
+        prev_end = pos[j] + run;
+        j += run;
+    }
+    sizes[ENC_OFFSETS] = pad8(2LL * nnz);
+    sizes[ENC_BITMAP] = pad8((len + 7) / 8);
+    sizes[ENC_RLE] = pad8(rle);
+}
+
+// Writes the position section of one block into zeroed memory
+void encode_positions(const long long* pos, int nnz, int encoding, unsigned char* out) {
+    if (encoding == ENC_OFFSETS) {
+        for (int j = 0; j < nnz; j++) {
+            unsigned short offset = (unsigned short)pos[j];
+            memcpy(out + 2 * j, &offset, sizeof(offset));
+        }
+    } else if (encoding == ENC_BITMAP) {
+        for (int j = 0; j < nnz; j++) out[pos[j] >> 3] |= (unsigned char)(1u << (pos[j] & 7));
+    } else {
+        long long prev_end = 0;
+        for (int j = 0; j < nnz;) {
+            int run = 1;
+            while (j + run < nnz && pos[j + run] == pos[j] + run) run++;
+            out = put_varint(out, (unsigned int)(pos[j] - prev_end));
+            out = put_varint(out, (unsigned int)run);
+            prev_end = pos[j] + run;
+            j += run;
+        }
+    }
+}
+
+// Expands the position section of one block to global indices
+void decode_positions(const unsigned char* in, int nnz, int len, int encoding, long long base, long long* index) {
+    if (encoding == ENC_OFFSETS) {
+        for (int j = 0; j < nnz; j++) {
+            unsigned short offset;
+            memcpy(&offset, in + 2 * j, sizeof(offset));
+            index[j] = base + offset;
+        }
+    } else if (encoding == ENC_BITMAP) {
+        int k = 0;
+        for (int w = 0; w < (len + 63) / 64; w++) {
+            unsigned long long word;
+            memcpy(&word, in + w * 8, sizeof(word));  // The section is padded to whole words
+            while (word) {
+                index[k++] = base + w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+        }
+    } else {
+        long long p = base;
+        for (int k = 0; k < nnz;) {
+            unsigned int gap, run;
+            in = get_varint(in, &gap);
+            in = get_varint(in, &run);
+            p += gap;
+            for (unsigned int r = 0; r < run; r++) index[k++] = p++;
+        }
+    }
+}
 
-    int chunk_size = n / size;
-    int* local_chunk = (int*)malloc(chunk_size * sizeof(int));
+/**
+ * Encodes a chunk: a parallel pass measures every block and picks its
+ * encoding (or the forced one), a prefix over the block sizes gives their
+ * offsets, and a second parallel pass writes the blocks. The values are
+ * compacted by the SIMD kernel straight into the stream.
+ */
+unsigned char* encode_chunk(const int* chunk, long long count, long long first, int force, CompressFn engine,
+                            long long histogram[NUM_ENCODINGS]) {
+    long long num_blocks = (count + ENCODE_BLOCK - 1) / ENCODE_BLOCK;
+    BlockHeader* blocks = (BlockHeader*)malloc((num_blocks > 0 ? num_blocks : 1) * sizeof(BlockHeader));
+    long long* offset = (long long*)malloc((num_blocks + 1) * sizeof(long long));
+    long long nnz = 0;
+
+    #pragma omp parallel reduction(+:nnz)
+    {
+        long long* pos = (long long*)malloc(ENCODE_BLOCK * sizeof(long long));
+        int* scratch = (int*)malloc(ENCODE_BLOCK * sizeof(int));
+        #pragma omp for schedule(static)
+        for (long long b = 0; b < num_blocks; b++) {
+            int len = (int)(count - b * ENCODE_BLOCK < ENCODE_BLOCK ? count - b * ENCODE_BLOCK : ENCODE_BLOCK);
+            int k = (int)engine(chunk + b * ENCODE_BLOCK, len, 0, pos, scratch, len);
+            long long sizes[NUM_ENCODINGS];
+            measure_block(pos, k, len, sizes);
+            int e = force;
+            if (e < 0) {
+                e = ENC_OFFSETS;
+                for (int c = 1; c < NUM_ENCODINGS; c++) {
+                    if (sizes[c] < sizes[e]) e = c;
+                }
+            }
+            BlockHeader block = {(unsigned int)e, (unsigned int)k, (unsigned int)sizes[e], 0};
+            blocks[b] = block;
+            offset[b + 1] = sizeof(BlockHeader) + sizes[e] + pad8(4LL * k);
+            nnz += k;
+        }
+        free(pos);
+        free(scratch);
+    }
 
-    MPI_Scatter(data, chunk_size, MPI_INT,
-                local_chunk, chunk_size, MPI_INT,
-                0, MPI_COMM_WORLD);
+    offset[0] = sizeof(StreamHeader);
+    for (long long b = 0; b < num_blocks; b++) offset[b + 1] += offset[b];
+    unsigned char* stream = (unsigned char*)malloc(offset[num_blocks]);
+    StreamHeader header = {first, count, nnz, offset[num_blocks]};
+    memcpy(stream, &header, sizeof(header));
 
-    // Each process builds fixed-size buffer (max chunk_size pairs)
-    int* sendbuf = (int*)malloc(chunk_size * 2 * sizeof(int));
-    for (int i = 0; i < chunk_size * 2; i++)
-        sendbuf[i] = -1; // mark as empty
+    #pragma omp parallel
+    {
+        long long* pos = (long long*)malloc(ENCODE_BLOCK * sizeof(long long));
+        #pragma omp for schedule(static)
+        for (long long b = 0; b < num_blocks; b++) {
+            int len = (int)(count - b * ENCODE_BLOCK < ENCODE_BLOCK ? count - b * ENCODE_BLOCK : ENCODE_BLOCK);
+            BlockHeader block = blocks[b];
+            unsigned char* positions = stream + offset[b] + sizeof(BlockHeader);
+            unsigned char* values = positions + block.position_bytes;
 
-    int pair_index = 0;
-    for (int i = 0; i < chunk_size; i++) {
-        if (local_chunk[i] != 0) {
-            int global_index = rank * chunk_size + i;
-            sendbuf[2 * pair_index]     = global_index;
-            sendbuf[2 * pair_index + 1] = local_chunk[i];
-            pair_index++;
+            // Zero the padding too, so streams are deterministic
+            memset(positions, 0, offset[b + 1] - offset[b] - sizeof(BlockHeader));
+            memcpy(stream + offset[b], &block, sizeof(block));
+            engine(chunk + b * ENCODE_BLOCK, len, 0, pos, (int*)values, block.nnz);
+            encode_positions(pos, (int)block.nnz, (int)block.encoding, positions);
         }
+        free(pos);
     }
 
-    // Gather all fixed-size buffers
-    int* recvbuf = NULL;
-    if (rank == 0)
-        recvbuf = (int*)malloc(size * chunk_size * 2 * sizeof(int));
+    for (int e = 0; e < NUM_ENCODINGS; e++) histogram[e] = 0;
+    for (long long b = 0; b < num_blocks; b++) histogram[blocks[b].encoding]++;
+    free(blocks);
+    free(offset);
+    return stream;
+}
+
+// Decodes one stream into index / value (sized by its nnz); returns the stream length in bytes
+long long decode_chunk(const unsigned char* stream, long long* index, int* value) {
+    StreamHeader header;
+    memcpy(&header, stream, sizeof(header));
+    long long num_blocks = (header.count + ENCODE_BLOCK - 1) / ENCODE_BLOCK;
+    long long* offset = (long long*)malloc((num_blocks > 0 ? num_blocks : 1) * sizeof(long long));
+    long long* out = (long long*)malloc((num_blocks > 0 ? num_blocks : 1) * sizeof(long long));
 
-    MPI_Gather(sendbuf, chunk_size * 2, MPI_INT,
-               recvbuf, chunk_size * 2, MPI_INT,
-               0, MPI_COMM_WORLD);
+    // Walk the block headers once to find every block's input and output offsets
+    long long at = sizeof(StreamHeader), k = 0;
+    for (long long b = 0; b < num_blocks; b++) {
+        BlockHeader block;
+        memcpy(&block, stream + at, sizeof(block));
+        offset[b] = at;
+        out[b] = k;
+        at += sizeof(BlockHeader) + block.position_bytes + pad8(4LL * block.nnz);
+        k += block.nnz;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (long long b = 0; b < num_blocks; b++) {
+        BlockHeader block;
+        memcpy(&block, stream + offset[b], sizeof(block));
+        int len = (int)(header.count - b * ENCODE_BLOCK < ENCODE_BLOCK ? header.count - b * ENCODE_BLOCK : ENCODE_BLOCK);
+        const unsigned char* positions = stream + offset[b] + sizeof(BlockHeader);
+        decode_positions(positions, (int)block.nnz, len, (int)block.encoding, header.first + b * ENCODE_BLOCK, index + out[b]);
+        memcpy(value + out[b], positions + block.position_bytes, 4LL * block.nnz);
+    }
+
+    free(offset);
+    free(out);
+    return header.bytes;
+}
+
+/**
+ * Reads this rank's share of a file of int32 values with collective MPI-IO.
+ * The file is split into units of unit values (1 for arrays, one row for
+ * matrices) and rank r gets units [u*r/size, u*(r+1)/size), so any length
+ * works and chunks differ by at most one unit. n, first and count are in values.
+ * A file that is not a whole number of units is an error.
+ */
+int* read_chunk(const char* path, long long unit, long long* n, long long* first, long long* count, int rank, int size) {
+    MPI_File fh;
+    MPI_Offset file_size;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_get_size(fh, &file_size);
+    long long values = (long long)file_size / sizeof(int), units = values / unit;
+    if (values % unit != 0) {
+        // A partial last row would otherwise be dropped without notice
+        if (rank == 0) fprintf(stderr, "Error: %s holds %lld values, not a multiple of %lld columns.\n", path, values, unit);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    *n = units * unit;
+    *first = units * rank / size * unit;
+    *count = units * (rank + 1) / size * unit - *first;
+    if (*count > INT_MAX) {
+        fprintf(stderr, "Error: rank %d would hold more than %d values, use more processes.\n", rank, INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int* chunk = (int*)malloc((*count > 0 ? *count : 1) * sizeof(int));
+    MPI_File_read_at_all(fh, *first * (MPI_Offset)sizeof(int), chunk, (int)*count, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    return chunk;
+}
+
+/**
+ * Gathers the encoded streams to rank 0 with MPI_Gatherv and decodes them
+ * there, so the bytes sent follow the encoded size instead of 12 bytes per
+ * (index, value) pair. Ranks are decoded in order, which keeps indexes sorted.
+ */
+void gather_encoded(const int* chunk, long long count, long long first, long long* total, long long* bytes,
+                    int rank, int size) {
+    long long histogram[NUM_ENCODINGS], global_histogram[NUM_ENCODINGS];
+    unsigned char* stream = encode_chunk(chunk, count, first, -1, engine_fns[best_engine()], histogram);
+    StreamHeader header;
+    memcpy(&header, stream, sizeof(header));
+
+    MPI_Allreduce(&header.nnz, total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&header.bytes, bytes, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Reduce(histogram, global_histogram, NUM_ENCODINGS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (*bytes > INT_MAX) {
+        if (rank == 0) fprintf(stderr, "Error: %lld encoded bytes do not fit in one MPI_Gatherv, use -o.\n", *bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int local = (int)header.bytes;
+    int* counts = NULL;
+    int* displs = NULL;
+    unsigned char* streams = NULL;
+    if (rank == 0) {
+        counts = (int*)malloc(size * sizeof(int));
+        displs = (int*)malloc(size * sizeof(int));
+        streams = (unsigned char*)malloc(*bytes);
+    }
+    MPI_Gather(&local, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        displs[0] = 0;
+        for (int r = 1; r < size; r++) displs[r] = displs[r - 1] + counts[r - 1];
+    }
+    MPI_Gatherv(stream, local, MPI_BYTE, streams, counts, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+    free(stream);
 
     if (rank == 0) {
+        long long* index = (long long*)malloc((*total > 0 ? *total : 1) * sizeof(long long));
+        int* value = (int*)malloc((*total > 0 ? *total : 1) * sizeof(int));
+        long long k = 0;
+        for (int r = 0; r < size; r++) {
+            StreamHeader h;
+            memcpy(&h, streams + displs[r], sizeof(h));
+            decode_chunk(streams + displs[r], index + k, value + k);
+            k += h.nnz;
+        }
+
         printf("Index-Value pairs (non-zero elements):\n");
-        for (int i = 0; i < size * chunk_size; i++) {
-            int index = recvbuf[2 * i];
-            int value = recvbuf[2 * i + 1];
-            if (index != -1) {
-                printf("%d,%d ", index, value);
+        for (long long i = 0; i < *total && i < MAX_PRINTED_PAIRS; i++) {
+            printf("%lld,%d ", index[i], value[i]);
+        }
+        if (*total > MAX_PRINTED_PAIRS) printf("... (%lld more)", *total - MAX_PRINTED_PAIRS);
+        printf("\n");
+        printf("Blocks: %lld offsets, %lld bitmap, %lld rle\n",
+               global_histogram[ENC_OFFSETS], global_histogram[ENC_BITMAP], global_histogram[ENC_RLE]);
+        free(counts);
+        free(displs);
+        free(streams);
+        free(index);
+        free(value);
+    }
+}
+
+/**
+ * Writes the pairs straight to a file with collective MPI-IO at the offset
+ * given by MPI_Exscan. Layout: int64 count, count int64 indices, count int32 values.
+ */
+void write_pairs(const char* path, const Compacted* c, long long offset, long long total, int rank) {
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Offset index_base = sizeof(long long);
+    MPI_Offset value_base = index_base + total * (MPI_Offset)sizeof(long long);
+    MPI_File_set_size(fh, value_base + total * (MPI_Offset)sizeof(int));
+
+    if (rank == 0) MPI_File_write_at(fh, 0, &total, 1, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, index_base + offset * (MPI_Offset)sizeof(long long),
+                          c->index, (int)c->count, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, value_base + offset * (MPI_Offset)sizeof(int),
+                          c->value, (int)c->count, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+}
+
+// Local CSR block of a row-distributed matrix; row_ptr is relative to the block
+typedef struct {
+    long long rows;
+    long long nnz;
+    long long* row_ptr;  // rows + 1 entries
+    int* col_idx;
+    int* value;
+} Csr;
+
+// Header of the sparse matrix file; the arrays follow at 8-byte aligned offsets so the file can be mmap'd
+typedef struct {
+    char magic[8];  // "CSR0001" or "COO0001"
+    long long rows;
+    long long cols;
+    long long nnz;
+} SparseHeader;
+
+/**
+ * Converts a block of dense rows to CSR: rows are counted in parallel, a
+ * prefix over the counts gives row_ptr, and every row is then compacted with
+ * the SIMD kernel straight into its slice of col_idx / value.
+ */
+Csr dense_to_csr(const int* block, long long rows, long long cols, CompressFn engine) {
+    Csr m;
+    m.rows = rows;
+    m.row_ptr = (long long*)malloc((rows + 1) * sizeof(long long));
+    m.row_ptr[0] = 0;
+
+    #pragma omp parallel for schedule(static)
+    for (long long r = 0; r < rows; r++) {
+        long long nonzeros = 0;
+        const int* row = block + r * cols;
+        for (long long c = 0; c < cols; c++) nonzeros += row[c] != 0;
+        m.row_ptr[r + 1] = nonzeros;
+    }
+    for (long long r = 0; r < rows; r++) m.row_ptr[r + 1] += m.row_ptr[r];
+    m.nnz = m.row_ptr[rows];
+    m.col_idx = (int*)malloc((m.nnz > 0 ? m.nnz : 1) * sizeof(int));
+    m.value = (int*)malloc((m.nnz > 0 ? m.nnz : 1) * sizeof(int));
+
+    #pragma omp parallel
+    {
+        // The kernels emit 64-bit positions; columns fit in 32 bits
+        long long* positions = (long long*)malloc((cols > 0 ? cols : 1) * sizeof(long long));
+        #pragma omp for schedule(static)
+        for (long long r = 0; r < rows; r++) {
+            long long start = m.row_ptr[r], k = m.row_ptr[r + 1] - start;
+            engine(block + r * cols, cols, 0, positions, m.value + start, k);
+            for (long long j = 0; j < k; j++) m.col_idx[start + j] = (int)positions[j];
+        }
+        free(positions);
+    }
+    return m;
+}
+
+/**
+ * Writes the global matrix with collective MPI-IO. The local row_ptr is
+ * shifted by this rank's nnz offset (from MPI_Exscan), which stitches the
+ * blocks into one consistent CSR. COO stores explicit int32 row indices instead.
+ *   CSR: header, int64 row_ptr[rows + 1], int32 col_idx[nnz], int32 value[nnz]
+ *   COO: header, int32 row[nnz], int32 col[nnz], int32 value[nnz]
+ */
+void write_sparse(const char* path, const Csr* m, int coo, long long first_row, long long rows, long long cols,
+                  long long offset, long long nnz, int rank) {
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    SparseHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, coo ? "COO0001" : "CSR0001");
+    header.rows = rows;
+    header.cols = cols;
+    header.nnz = nnz;
+
+    MPI_Offset base = sizeof(SparseHeader);
+    MPI_Offset first_base = coo ? base : base + (rows + 1) * (MPI_Offset)sizeof(long long);
+    MPI_Offset col_base = first_base + (coo ? nnz * (MPI_Offset)sizeof(int) : 0);
+    MPI_Offset value_base = col_base + nnz * (MPI_Offset)sizeof(int);
+    MPI_File_set_size(fh, value_base + nnz * (MPI_Offset)sizeof(int));
+
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+        if (!coo) MPI_File_write_at(fh, base + rows * (MPI_Offset)sizeof(long long), &nnz, 1, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    }
+
+    if (coo) {
+        int* row_idx = (int*)malloc((m->nnz > 0 ? m->nnz : 1) * sizeof(int));
+        #pragma omp parallel for schedule(static)
+        for (long long r = 0; r < m->rows; r++) {
+            for (long long j = m->row_ptr[r]; j < m->row_ptr[r + 1]; j++) row_idx[j] = (int)(first_row + r);
+        }
+        MPI_File_write_at_all(fh, base + offset * (MPI_Offset)sizeof(int), row_idx, (int)m->nnz, MPI_INT, MPI_STATUS_IGNORE);
+        free(row_idx);
+    } else {
+        long long* row_ptr = (long long*)malloc((m->rows > 0 ? m->rows : 1) * sizeof(long long));
+        for (long long r = 0; r < m->rows; r++) row_ptr[r] = m->row_ptr[r] + offset;
+        MPI_File_write_at_all(fh, base + first_row * (MPI_Offset)sizeof(long long), row_ptr, (int)m->rows,
+                              MPI_LONG_LONG, MPI_STATUS_IGNORE);
+        free(row_ptr);
+    }
+    MPI_File_write_at_all(fh, col_base + offset * (MPI_Offset)sizeof(int), m->col_idx, (int)m->nnz, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, value_base + offset * (MPI_Offset)sizeof(int), m->value, (int)m->nnz, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+}
+
+/**
+ * 2D mode: a row-major int32 matrix with cols columns is distributed by rows,
+ * converted to CSR per rank and written as one global CSR or COO file.
+ * Reports the phase times (slowest rank) and dense vs. sparse memory.
+ */
+void convert_matrix(const char* in_path, long long cols, const char* out_path, int coo, int rank, int size) {
+    if (cols < 1 || cols > INT_MAX) {
+        if (rank == 0) printf("Error: cols must be between 1 and %d.\n", INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    double t0 = MPI_Wtime();
+    long long n, first, count;
+    int* block = read_chunk(in_path, cols, &n, &first, &count, rank, size);
+    long long rows = n / cols, first_row = first / cols;
+    double t1 = MPI_Wtime();
+
+    Csr m = dense_to_csr(block, count / cols, cols, engine_fns[best_engine()]);
+    free(block);
+    if (m.nnz > INT_MAX) {
+        fprintf(stderr, "Error: rank %d holds more than %d nonzeros, use more processes.\n", rank, INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    long long offset = 0, nnz;
+    MPI_Exscan(&m.nnz, &offset, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) offset = 0;  // MPI_Exscan leaves rank 0's result undefined
+    MPI_Allreduce(&m.nnz, &nnz, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    double t2 = MPI_Wtime();
+
+    write_sparse(out_path, &m, coo, first_row, rows, cols, offset, nnz, rank);
+    double t3 = MPI_Wtime();
+
+    // Slowest rank per phase and overall, and the largest per-rank dense and CSR footprints
+    double local[6] = {t1 - t0, t2 - t1, t3 - t2, (double)count * sizeof(int),
+                       (double)(m.rows + 1) * sizeof(long long) + (double)m.nnz * 2 * sizeof(int), t3 - t0};
+    double global[6];
+    MPI_Reduce(local, global, 6, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        double dense_mb = (double)n * sizeof(int) / 1e6;
+        double sparse_mb = coo ? nnz * 3.0 * sizeof(int) / 1e6
+                               : ((rows + 1) * (double)sizeof(long long) + nnz * 2.0 * sizeof(int)) / 1e6;
+        printf("%lld x %lld matrix, %lld nonzeros (%.2f%%) -> %s with %d processes x %d threads\n",
+               rows, cols, nnz, n > 0 ? 100.0 * nnz / n : 0.0, coo ? "COO" : "CSR", size, omp_get_max_threads());
+        printf("Read: %.6f s | convert: %.6f s (%.3f GB/s) | write: %.6f s\n",
+               global[0], global[1], global[1] > 0 ? n * sizeof(int) / global[1] / 1e9 : 0.0, global[2]);
+        printf("Memory: dense %.1f MB, %s %.1f MB (%.1f%%); per rank at most %.1f MB dense + %.1f MB CSR\n",
+               dense_mb, coo ? "COO" : "CSR", sparse_mb, dense_mb > 0 ? 100.0 * sparse_mb / dense_mb : 0.0,
+               global[3] / 1e6, global[4] / 1e6);
+        printf("Execution time: %.6f seconds\n", global[5]);
+    }
+
+    free(m.row_ptr);
+    free(m.col_idx);
+    free(m.value);
+}
+
+// SplitMix64 of a global index
+unsigned long long mix(long long i) {
+    unsigned long long z = (unsigned long long)(i + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Value of element i, depending only on the global index. Elements come in
+ * aligned groups of cluster that are all nonzero with probability density
+ * (cluster 1 gives independent elements).
+ */
+int synthetic_value(long long i, unsigned long long threshold, int cluster) {
+    unsigned long long z = mix(i);
+    unsigned long long group = cluster == 1 ? z : mix(i / cluster);
+    return (group >> 11) < threshold ? (int)(z % 1000) + 1 : 0;
+}
+
+void fill_values(int* buf, long long first, long long count, double density, int cluster) {
+    unsigned long long threshold = (unsigned long long)(density * 9007199254740992.0);
+    #pragma omp parallel for
+    for (long long i = 0; i < count; i++) buf[i] = synthetic_value(first + i, threshold, cluster);
+}
+
+/**
+ * Writes count int32 values, nonzero with probability density in groups of
+ * cluster, with collective MPI-IO. The file is the same for any process count.
+ */
+void generate_file(const char* path, long long count, double density, int cluster, int rank, int size) {
+    long long first = count * rank / size, local = count * (rank + 1) / size - first;
+    if (local > INT_MAX) {
+        fprintf(stderr, "Error: rank %d would write more than %d values, use more processes.\n", rank, INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int* buf = (int*)malloc((local > 0 ? local : 1) * sizeof(int));
+    fill_values(buf, first, local, density, cluster);
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, count * (MPI_Offset)sizeof(int));
+    MPI_File_write_at_all(fh, first * (MPI_Offset)sizeof(int), buf, (int)local, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    free(buf);
+
+    if (rank == 0) printf("Wrote %lld int32 values (density %.4f) to %s\n", count, density, path);
+}
+
+/**
+ * Density sweep on rank 0: input GB/s of every single-threaded kernel and of
+ * the OpenMP version with the widest kernel. Each result is checked against
+ * the scalar loop.
+ */
+void run_benchmark(long long n) {
+    const double densities[] = {0.001, 0.01, 0.1, 0.3, 0.5, 0.7, 0.9, 1.0};
+    const int num_densities = sizeof(densities) / sizeof(densities[0]);
+    const int repeats = 3;
+    int* data = (int*)malloc(n * sizeof(int));
+    long long* index = (long long*)malloc(n * sizeof(long long));
+    int* value = (int*)malloc(n * sizeof(int));
+    long long* ref_index = (long long*)malloc(n * sizeof(long long));
+    int* ref_value = (int*)malloc(n * sizeof(int));
+
+    printf("%-8s", "density");
+    for (int e = 0; e < NUM_ENGINES; e++) printf(" %10s", engine_names[e]);
+    printf(" %10s   (GB/s, %d threads)\n", "parallel", omp_get_max_threads());
+
+    for (int d = 0; d < num_densities; d++) {
+        fill_values(data, 0, n, densities[d], 1);
+        long long expected = compress_scalar(data, n, 0, ref_index, ref_value, n);
+        printf("%-8.3f", densities[d]);
+
+        for (int e = 0; e <= NUM_ENGINES; e++) {
+            double best = 1e30;
+            long long kept = 0;
+            for (int r = 0; r < repeats; r++) {
+                double t0 = MPI_Wtime();
+                if (e < NUM_ENGINES) {
+                    kept = engine_fns[e](data, n, 0, index, value, n);
+                } else {
+                    Compacted c = {index, value, 0};
+                    compact_parallel(data, n, 0, engine_fns[best_engine()], &c);
+                    kept = c.count;
+                }
+                double t = MPI_Wtime() - t0;
+                if (t < best) best = t;
             }
+            if (kept != expected || memcmp(index, ref_index, kept * sizeof(long long)) != 0 ||
+                memcmp(value, ref_value, kept * sizeof(int)) != 0) {
+                fprintf(stderr, "Error: %s output differs from the scalar loop\n", e < NUM_ENGINES ? engine_names[e] : "parallel");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            printf(" %10.3f", n * sizeof(int) / best / 1e9);
         }
         printf("\n");
-        free(recvbuf);
     }
 
+    free(data);
+    free(index);
+    free(value);
+    free(ref_index);
+    free(ref_value);
+}
+
+/**
+ * Encoding sweep on rank 0 over density and clustering: bytes per nonzero of
+ * every encoding (and of the automatic choice) against 12-byte pairs, with
+ * encode and decode throughput in GB/s of dense input. Every round trip is
+ * checked against the scalar compaction.
+ */
+void run_encoding_benchmark(long long n) {
+    const double densities[] = {0.0001, 0.001, 0.01, 0.1, 0.5};
+    const int clusters[] = {1, 64};
+    const int num_densities = sizeof(densities) / sizeof(densities[0]);
+    const int repeats = 3;
+    int* data = (int*)malloc(n * sizeof(int));
+    long long* index = (long long*)malloc(n * sizeof(long long));
+    int* value = (int*)malloc(n * sizeof(int));
+    long long* ref_index = (long long*)malloc(n * sizeof(long long));
+    int* ref_value = (int*)malloc(n * sizeof(int));
+    long long histogram[NUM_ENCODINGS];
+
+    printf("%-8s %-7s %-8s %12s %10s %10s %10s\n", "density", "cluster", "encoding", "bytes/nnz", "vs pairs", "enc GB/s", "dec GB/s");
+    for (int c = 0; c < 2; c++) {
+        for (int d = 0; d < num_densities; d++) {
+            fill_values(data, 0, n, densities[d], clusters[c]);
+            long long expected = compress_scalar(data, n, 0, ref_index, ref_value, n);
+
+            for (int e = 0; e <= NUM_ENCODINGS; e++) {
+                double best_encode = 1e30, best_decode = 1e30;
+                unsigned char* stream = NULL;
+                for (int r = 0; r < repeats; r++) {
+                    free(stream);
+                    double t0 = MPI_Wtime();
+                    stream = encode_chunk(data, n, 0, e < NUM_ENCODINGS ? e : -1, engine_fns[best_engine()], histogram);
+                    double t1 = MPI_Wtime();
+                    decode_chunk(stream, index, value);
+                    double t2 = MPI_Wtime();
+                    if (t1 - t0 < best_encode) best_encode = t1 - t0;
+                    if (t2 - t1 < best_decode) best_decode = t2 - t1;
+                }
+
+                StreamHeader header;
+                memcpy(&header, stream, sizeof(header));
+                if (header.nnz != expected || memcmp(index, ref_index, expected * sizeof(long long)) != 0 ||
+                    memcmp(value, ref_value, expected * sizeof(int)) != 0) {
+                    fprintf(stderr, "Error: %s round trip differs from the input\n", encoding_names[e]);
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+                printf("%-8.4f %-7d %-8s %12.2f %9.1f%% %10.3f %10.3f\n", densities[d], clusters[c], encoding_names[e],
+                       expected > 0 ? (double)header.bytes / expected : 0.0,
+                       expected > 0 ? 100.0 * header.bytes / (12.0 * expected) : 0.0,
+                       n * sizeof(int) / best_encode / 1e9, n * sizeof(int) / best_decode / 1e9);
+                free(stream);
+            }
+        }
+    }
+
+    free(data);
+    free(index);
+    free(value);
+    free(ref_index);
+    free(ref_value);
+}
+
+int main(int argc, char** argv) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    init_permute_table();
+
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "-B") == 0) {
+        long long n = (argc == 3 ? atoll(argv[2]) : 16) * 1000000LL;
+        if (rank == 0 && n > 0) run_benchmark(n);
+        MPI_Finalize();
+        return 0;
+    }
+
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "-m") == 0) {
+        int coo = argc == 6 && strcmp(argv[5], "coo") == 0;
+        if (argc == 6 && !coo && strcmp(argv[5], "csr") != 0) {
+            if (rank == 0) printf("Error: the sparse format must be csr or coo.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        convert_matrix(argv[2], atoll(argv[3]), argv[4], coo, rank, size);
+        MPI_Finalize();
+        return 0;
+    }
+
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "-E") == 0) {
+        long long n = (argc == 3 ? atoll(argv[2]) : 16) * 1000000LL;
+        if (rank == 0 && n > 0) run_encoding_benchmark(n);
+        MPI_Finalize();
+        return 0;
+    }
+
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "-g") == 0) {
+        int cluster = argc == 6 ? atoi(argv[5]) : 1;
+        generate_file(argv[2], atoll(argv[3]), atof(argv[4]), cluster > 0 ? cluster : 1, rank, size);
+        MPI_Finalize();
+        return 0;
+    }
+
+    const char* in_path = NULL;
+    const char* out_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (in_path == NULL && argv[i][0] != '-') {
+            in_path = argv[i];
+        } else {
+            if (rank == 0) {
+                printf("Usage: %s [input.bin] [-o pairs.bin]\n", argv[0]);
+                printf("       %s -m <dense.bin> <cols> <out.bin> [csr|coo]\n", argv[0]);
+                printf("       %s -g <file> <count> <density> [cluster]\n", argv[0]);
+                printf("       %s -B [million_values]\n", argv[0]);
+                printf("       %s -E [million_values]\n", argv[0]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    long long n, first, count;
+    int* local_chunk;
+    if (in_path) {
+        local_chunk = read_chunk(in_path, 1, &n, &first, &count, rank, size);
+    } else {
+        // Built-in example; split unevenly like a file of any length
+        int data[10] = {5, 4, 0, 0, 0, 1, 0, 0, 2, 0};
+        n = 10;
+        first = n * rank / size;
+        count = n * (rank + 1) / size - first;
+        local_chunk = (int*)malloc((count > 0 ? count : 1) * sizeof(int));
+        memcpy(local_chunk, data + first, count * sizeof(int));
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_start = MPI_Wtime();
+
+    long long total, bytes;
+    if (out_path) {
+        Compacted c = {NULL, NULL, 0};
+        compact_parallel(local_chunk, count, first, engine_fns[best_engine()], &c);
+
+        // Global position of this rank's first pair, and the total number of pairs
+        long long offset = 0;
+        MPI_Exscan(&c.count, &offset, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        if (rank == 0) offset = 0;  // MPI_Exscan leaves rank 0's result undefined
+        MPI_Allreduce(&c.count, &total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+        write_pairs(out_path, &c, offset, total, rank);
+        bytes = total * (long long)(sizeof(long long) + sizeof(int));
+        free(c.index);
+        free(c.value);
+    } else {
+        gather_encoded(local_chunk, count, first, &total, &bytes, rank, size);
+    }
+
+    double elapsed = MPI_Wtime() - t_start;
+    if (rank == 0 && in_path) {
+        printf("Kept %lld of %lld elements (%.2f%%) with %d processes, %lld bytes %s (%lld as pairs)\n",
+               total, n, n > 0 ? 100.0 * total / n : 0.0, size, bytes, out_path ? "written" : "gathered",
+               total * (long long)(sizeof(long long) + sizeof(int)));
+    }
+    if (rank == 0) printf("Execution time: %.6f seconds\n", elapsed);
+
     free(local_chunk);
-    free(sendbuf);
     MPI_Finalize();
     return 0;
 }
@@ -207,7 +207,7 @@ int main(int argc, char* argv[]) {
         
         // End timer and print execution time
         double end_time = MPI_Wtime();
-        printf("Execution time: %.2f seconds\n", end_time - start_time);
+        printf("Execution time: %.6f seconds\n", end_time - start_time);
     } else {
         // Worker process
         worker_process(rank);
@@ -0,0 +1,582 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: Hybrid MPI+OpenMP distributed sort of int64 binary files (hypercube bitonic sort and sample sort).
+ */
+
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define INSERTION_CUTOFF 16
+#define OVERSAMPLE 64          // Regular samples per rank for the sample sort splitters
+#define IO_CHUNK (1LL << 27)   // Values per MPI-IO call, keeps every count below INT_MAX
+
+enum { ALGO_BITONIC, ALGO_SAMPLE };
+
+const char* algo_names[] = {"bitonic", "sample"};
+
+// Per-phase wall time of one rank
+typedef struct {
+    double local_sort;
+    double exchange;
+    double merge;
+} PhaseTimes;
+
+// SplitMix64 of the global index: the input is the same for any process count
+long long random_key(long long i) {
+    unsigned long long z = (unsigned long long)i * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (long long)(z ^ (z >> 31));
+}
+
+void fill_keys(long long* keys, long long first, long long count) {
+    #pragma omp parallel for
+    for (long long i = 0; i < count; i++) keys[i] = random_key(first + i);
+}
+
+void insertion_sort(long long* a, long long n) {
+    for (long long i = 1; i < n; i++) {
+        long long v = a[i], j = i - 1;
+        while (j >= 0 && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+}
+
+// Sequential quicksort (median of three, insertion sort for short ranges)
+void quick_sort(long long* a, long long n) {
+    while (n > INSERTION_CUTOFF) {
+        long long mid = n / 2, t;
+        if (a[mid] < a[0]) { t = a[mid]; a[mid] = a[0]; a[0] = t; }
+        if (a[n - 1] < a[0]) { t = a[n - 1]; a[n - 1] = a[0]; a[0] = t; }
+        if (a[n - 1] < a[mid]) { t = a[n - 1]; a[n - 1] = a[mid]; a[mid] = t; }
+        long long pivot = a[mid];
+
+        long long i = 0, j = n - 1;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                t = a[i]; a[i] = a[j]; a[j] = t;
+                i++;
+                j--;
+            }
+        }
+        // Recurse into the smaller side, loop on the larger one
+        if (j + 1 < n - i) {
+            quick_sort(a, j + 1);
+            a += i;
+            n -= i;
+        } else {
+            quick_sort(a + i, n - i);
+            n = j + 1;
+        }
+    }
+    insertion_sort(a, n);
+}
+
+// How many of the first k outputs of merge(a, b) come from a (ties are taken from a first)
+long long co_rank(long long k, const long long* a, long long na, const long long* b, long long nb) {
+    long long lo = k > nb ? k - nb : 0, hi = k < na ? k : na;
+    while (lo < hi) {
+        long long i = lo + (hi - lo) / 2, j = k - i;
+        if (j > 0 && i < na && a[i] <= b[j - 1]) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Writes outputs [out_first, out_first + out_count) of the merge of the sorted
+ * arrays a and b to out. Every thread finds the input split of its share of
+ * the output by binary search (merge path), so the pieces are merged
+ * independently without synchronisation.
+ */
+void parallel_merge(const long long* a, long long na, const long long* b, long long nb, long long* out, long long out_first, long long out_count) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        long long k0 = out_first + out_count * t / threads, k1 = out_first + out_count * (t + 1) / threads;
+        long long i = co_rank(k0, a, na, b, nb), j = k0 - i;
+        long long i_end = co_rank(k1, a, na, b, nb), j_end = k1 - i_end;
+        long long* o = out + (k0 - out_first);
+
+        while (i < i_end && j < j_end) *o++ = a[i] <= b[j] ? a[i++] : b[j++];
+        while (i < i_end) *o++ = a[i++];
+        while (j < j_end) *o++ = b[j++];
+    }
+}
+
+/**
+ * Merges the sorted runs src[bounds[r], bounds[r + 1]) for r < runs in
+ * log2(runs) rounds of pairwise parallel merges, alternating between src and
+ * tmp. Returns the buffer that holds the result.
+ */
+long long* merge_runs(long long* src, long long* tmp, const long long* bounds, int runs) {
+    for (int width = 1; width < runs; width *= 2) {
+        for (int r = 0; r < runs; r += 2 * width) {
+            int m = r + width < runs ? r + width : runs, e = r + 2 * width < runs ? r + 2 * width : runs;
+            long long lo = bounds[r], mid = bounds[m], hi = bounds[e];
+            parallel_merge(src + lo, mid - lo, src + mid, hi - mid, tmp + lo, 0, hi - lo);
+        }
+        long long* t = src;
+        src = tmp;
+        tmp = t;
+    }
+    return src;
+}
+
+// Node-local sort: one quicksort per thread slice, then a parallel merge of the slices
+long long* local_sort(long long* keys, long long* tmp, long long n) {
+    int runs = omp_get_max_threads();
+    long long* bounds = (long long*)malloc((runs + 1) * sizeof(long long));
+    for (int r = 0; r <= runs; r++) bounds[r] = n * r / runs;
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int r = 0; r < runs; r++) quick_sort(keys + bounds[r], bounds[r + 1] - bounds[r]);
+
+    long long* sorted = merge_runs(keys, tmp, bounds, runs);
+    free(bounds);
+    return sorted;
+}
+
+/**
+ * One hypercube step: both partners swap their m keys, and each keeps the
+ * lower or upper m keys of the union. Only that half of the merge is
+ * computed. The merge is skipped when the two blocks are already in order.
+ * *keys and *tmp are swapped when the result lands in tmp.
+ */
+void compare_split(long long** keys, long long** tmp, long long* recv, long long m, int partner, int keep_low, MPI_Comm comm, PhaseTimes* times) {
+    double t_start = MPI_Wtime();
+    MPI_Sendrecv(*keys, (int)m, MPI_LONG_LONG, partner, 0, recv, (int)m, MPI_LONG_LONG, partner, 0, comm, MPI_STATUS_IGNORE);
+    double t_exchanged = MPI_Wtime();
+
+    long long* mine = *keys;
+    int in_order = keep_low ? mine[m - 1] <= recv[0] : recv[m - 1] <= mine[0];
+    if (!in_order) {
+        parallel_merge(mine, m, recv, m, *tmp, keep_low ? 0 : m, m);
+        *keys = *tmp;
+        *tmp = mine;
+    }
+    times->exchange += t_exchanged - t_start;
+    times->merge += MPI_Wtime() - t_exchanged;
+}
+
+/**
+ * Distributed bitonic sort over a power-of-two number of ranks. The blocks
+ * are padded to m = ceil(n / p) keys with LLONG_MAX, so every compare-split
+ * exchanges equal halves. The padding sorts to the end, so rank r ends with
+ * the global positions [r * m, r * m + *out_count) of the sorted sequence.
+ * Each rank sorts its block locally, then in stage i of log2(p) it
+ * compare-splits with the partners rank ^ (1 << j) for j = i, ..., 0. The
+ * direction of a stage follows bit i + 1 of the rank.
+ */
+long long* bitonic_sort_dist(long long* keys, long long count, long long n, long long* out_count, MPI_Comm comm, PhaseTimes* times) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    long long m = (n + size - 1) / size;
+
+    long long* block = (long long*)malloc(m * sizeof(long long));
+    long long* tmp = (long long*)malloc(m * sizeof(long long));
+    long long* recv = (long long*)malloc(m * sizeof(long long));
+    memcpy(block, keys, count * sizeof(long long));
+    for (long long i = count; i < m; i++) block[i] = LLONG_MAX;
+
+    double t_start = MPI_Wtime();
+    long long* sorted = local_sort(block, tmp, m);
+    if (sorted != block) {
+        tmp = block;
+        block = sorted;
+    }
+    times->local_sort += MPI_Wtime() - t_start;
+
+    for (int i = 0; (1 << i) < size; i++) {
+        int ascending = ((rank >> (i + 1)) & 1) == 0;
+        for (int j = i; j >= 0; j--) {
+            int partner = rank ^ (1 << j);
+            compare_split(&block, &tmp, recv, m, partner, (rank < partner) == ascending, comm, times);
+        }
+    }
+
+    long long valid = n - rank * m;
+    *out_count = valid < 0 ? 0 : valid < m ? valid : m;
+    free(tmp);
+    free(recv);
+    return block;
+}
+
+/**
+ * Sample sort (regular sampling). Each rank sorts its keys and contributes
+ * OVERSAMPLE evenly spaced samples. All ranks sort the gathered samples and
+ * pick the same p - 1 splitters, so each rank cuts its sorted keys into p
+ * buckets by binary search. A single MPI_Alltoallv delivers bucket d to rank
+ * d, which merges the p sorted runs it received. Every key equal to a
+ * splitter goes to the lower bucket, so many copies of one key end up on one
+ * rank.
+ */
+long long* sample_sort_dist(long long* keys, long long count, long long* out_count, MPI_Comm comm, PhaseTimes* times) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    double t_start = MPI_Wtime();
+    long long* tmp = (long long*)malloc((count > 0 ? count : 1) * sizeof(long long));
+    long long* sorted = local_sort(keys, tmp, count);
+    long long* spare = sorted == keys ? tmp : keys;
+    double t_sorted = MPI_Wtime();
+
+    // Splitters from the regular samples of all ranks
+    long long samples[OVERSAMPLE];
+    int n_samples = count < OVERSAMPLE ? (int)count : OVERSAMPLE;
+    for (int s = 0; s < n_samples; s++) samples[s] = sorted[count * (2 * s + 1) / (2 * n_samples)];
+    int* sample_counts = (int*)malloc(size * sizeof(int));
+    int* sample_displs = (int*)malloc(size * sizeof(int));
+    MPI_Allgather(&n_samples, 1, MPI_INT, sample_counts, 1, MPI_INT, comm);
+    int total_samples = 0;
+    for (int r = 0; r < size; r++) {
+        sample_displs[r] = total_samples;
+        total_samples += sample_counts[r];
+    }
+    long long* all_samples = (long long*)malloc((total_samples > 0 ? total_samples : 1) * sizeof(long long));
+    MPI_Allgatherv(samples, n_samples, MPI_LONG_LONG, all_samples, sample_counts, sample_displs, MPI_LONG_LONG, comm);
+    quick_sort(all_samples, total_samples);
+
+    // Bucket d holds the keys in (splitter[d - 1], splitter[d]]
+    int* send_counts = (int*)malloc(size * sizeof(int));
+    int* send_displs = (int*)malloc(size * sizeof(int));
+    int* recv_counts = (int*)malloc(size * sizeof(int));
+    int* recv_displs = (int*)malloc(size * sizeof(int));
+    long long begin = 0;
+    for (int d = 0; d < size; d++) {
+        long long end = count;
+        if (d < size - 1 && total_samples > 0) {
+            long long splitter = all_samples[(long long)total_samples * (d + 1) / size];
+            long long lo = begin, hi = count;
+            while (lo < hi) {
+                long long mid = lo + (hi - lo) / 2;
+                if (sorted[mid] <= splitter) lo = mid + 1;
+                else hi = mid;
+            }
+            end = lo;
+        }
+        send_displs[d] = (int)begin;
+        send_counts[d] = (int)(end - begin);
+        begin = end;
+    }
+
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm);
+    long long received = 0;
+    for (int r = 0; r < size; r++) received += recv_counts[r];
+    if (received > INT_MAX) {
+        fprintf(stderr, "Error: a rank would receive more than %d keys, use more processes.\n", INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    long long* bounds = (long long*)malloc((size + 1) * sizeof(long long));
+    bounds[0] = 0;
+    for (int r = 0; r < size; r++) {
+        recv_displs[r] = (int)bounds[r];
+        bounds[r + 1] = bounds[r] + recv_counts[r];
+    }
+
+    free(spare);
+    long long* runs = (long long*)malloc((received > 0 ? received : 1) * sizeof(long long));
+    MPI_Alltoallv(sorted, send_counts, send_displs, MPI_LONG_LONG, runs, recv_counts, recv_displs, MPI_LONG_LONG, comm);
+    free(sorted);
+    double t_exchanged = MPI_Wtime();
+
+    long long* merge_tmp = (long long*)malloc((received > 0 ? received : 1) * sizeof(long long));
+    long long* result = merge_runs(runs, merge_tmp, bounds, size);
+    free(result == runs ? merge_tmp : runs);
+
+    times->local_sort += t_sorted - t_start;
+    times->exchange += t_exchanged - t_sorted;
+    times->merge += MPI_Wtime() - t_exchanged;
+    *out_count = received;
+
+    free(sample_counts);
+    free(sample_displs);
+    free(all_samples);
+    free(send_counts);
+    free(send_displs);
+    free(recv_counts);
+    free(recv_displs);
+    free(bounds);
+    return result;
+}
+
+/**
+ * Runs one algorithm on the count keys of this rank (n in total over comm).
+ * Returns the sorted keys of this rank (*out_count of them, a contiguous
+ * piece of the global order) and the per-phase times, maximum over the ranks.
+ * keys is consumed.
+ */
+long long* distributed_sort(int algo, long long* keys, long long count, long long n, long long* out_count, MPI_Comm comm, PhaseTimes* max_times) {
+    PhaseTimes times = {0.0, 0.0, 0.0};
+    long long* sorted;
+
+    if (algo == ALGO_BITONIC) {
+        sorted = bitonic_sort_dist(keys, count, n, out_count, comm, &times);
+        free(keys);
+    } else {
+        sorted = sample_sort_dist(keys, count, out_count, comm, &times);
+    }
+    MPI_Allreduce(&times, max_times, 3, MPI_DOUBLE, MPI_MAX, comm);
+    return sorted;
+}
+
+// Wrapping sum and xor of the keys of all ranks, the multiset fingerprint checked after sorting
+void fingerprint(const long long* keys, long long count, unsigned long long* sum, unsigned long long* xor_all, MPI_Comm comm) {
+    unsigned long long s = 0, x = 0;
+    #pragma omp parallel for reduction(+:s) reduction(^:x)
+    for (long long i = 0; i < count; i++) {
+        s += (unsigned long long)keys[i];
+        x ^= (unsigned long long)keys[i];
+    }
+    MPI_Allreduce(&s, sum, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    MPI_Allreduce(&x, xor_all, 1, MPI_UNSIGNED_LONG_LONG, MPI_BXOR, comm);
+}
+
+/**
+ * Checks that the concatenation of the ranks' pieces is sorted and that it
+ * holds the same multiset of keys as the input (count, sum and xor).
+ */
+int verify_sorted(const long long* keys, long long count, unsigned long long input_sum, unsigned long long input_xor, long long n, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    long long local_ok = 1;
+    #pragma omp parallel for reduction(&&:local_ok)
+    for (long long i = 1; i < count; i++) {
+        if (keys[i - 1] > keys[i]) local_ok = 0;
+    }
+
+    // Every rank publishes whether it holds keys and its first and last key
+    long long edge[3] = {count, count > 0 ? keys[0] : 0, count > 0 ? keys[count - 1] : 0};
+    long long* edges = (long long*)malloc(3 * size * sizeof(long long));
+    MPI_Allgather(edge, 3, MPI_LONG_LONG, edges, 3, MPI_LONG_LONG, comm);
+    long long previous = LLONG_MIN;
+    for (int r = 0; r < size; r++) {
+        if (edges[3 * r] == 0) continue;
+        if (edges[3 * r + 1] < previous) local_ok = 0;
+        previous = edges[3 * r + 2];
+    }
+    free(edges);
+
+    long long ok, total;
+    unsigned long long output_sum, output_xor;
+    MPI_Allreduce(&local_ok, &ok, 1, MPI_LONG_LONG, MPI_LAND, comm);
+    MPI_Allreduce(&count, &total, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    fingerprint(keys, count, &output_sum, &output_xor, comm);
+    return ok && total == n && output_sum == input_sum && output_xor == input_xor;
+}
+
+/**
+ * Collective read or write of count keys at key offset first. Large slices
+ * are split into IO_CHUNK pieces, and every rank issues the same number of
+ * calls, so each MPI count stays below INT_MAX.
+ */
+void file_io(MPI_File fh, long long first, long long* keys, long long count, int write) {
+    long long pieces = (count + IO_CHUNK - 1) / IO_CHUNK, max_pieces;
+    MPI_Allreduce(&pieces, &max_pieces, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+
+    for (long long p = 0; p < max_pieces; p++) {
+        long long lo = p * IO_CHUNK < count ? p * IO_CHUNK : count;
+        long long len = count - lo < IO_CHUNK ? count - lo : IO_CHUNK;
+        MPI_Offset offset = (MPI_Offset)(first + lo) * 8;
+        if (write) {
+            MPI_File_write_at_all(fh, offset, keys + lo, (int)len, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+        } else {
+            MPI_File_read_at_all(fh, offset, keys + lo, (int)len, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+        }
+    }
+}
+
+/**
+ * File mode: every rank reads its uneven slice of the int64 input, the ranks
+ * sort together, and each rank writes its sorted piece at its exscan offset
+ * of the output file.
+ */
+void sort_file(const char* in_path, const char* out_path, int algo, int rank, int size) {
+    MPI_File fh;
+    MPI_Offset file_size;
+
+    if (algo == ALGO_BITONIC && (size & (size - 1)) != 0) {
+        if (rank == 0) fprintf(stderr, "Error: bitonic sort needs a power-of-two number of processes.\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (MPI_File_open(MPI_COMM_WORLD, in_path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s\n", in_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_get_size(fh, &file_size);
+    long long n = (long long)file_size / 8;
+    long long first = n * rank / size, count = n * (rank + 1) / size - first;
+    if (n == 0 || (n + size - 1) / size > INT_MAX) {
+        if (rank == 0) fprintf(stderr, "Error: the input must hold between 1 and %d keys per process.\n", INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    long long* keys = (long long*)malloc((count > 0 ? count : 1) * sizeof(long long));
+    double t_start = MPI_Wtime();
+    file_io(fh, first, keys, count, 0);
+    MPI_File_close(&fh);
+    unsigned long long input_sum, input_xor;
+    fingerprint(keys, count, &input_sum, &input_xor, MPI_COMM_WORLD);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_read = MPI_Wtime();
+    long long out_count;
+    PhaseTimes times;
+    long long* sorted = distributed_sort(algo, keys, count, n, &out_count, MPI_COMM_WORLD, &times);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_sort = MPI_Wtime();
+
+    long long out_first = 0, max_count;
+    MPI_Exscan(&out_count, &out_first, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) out_first = 0;
+    MPI_Reduce(&out_count, &max_count, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (MPI_File_open(MPI_COMM_WORLD, out_path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", out_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, n * 8);
+    file_io(fh, out_first, sorted, out_count, 1);
+    MPI_File_close(&fh);
+    double t_write = MPI_Wtime();
+
+    int ok = verify_sorted(sorted, out_count, input_sum, input_xor, n, MPI_COMM_WORLD);
+    free(sorted);
+
+    if (rank == 0) {
+        printf("%s sort of %lld int64 keys with %d processes x %d threads\n",
+               algo == ALGO_BITONIC ? "Bitonic" : "Sample", n, size, omp_get_max_threads());
+        printf("Read: %.6f s | sort: %.6f s | write: %.6f s\n", t_read - t_start, t_sort - t_read, t_write - t_sort);
+        printf("Local sort: %.6f s | exchange: %.6f s | merge: %.6f s\n", times.local_sort, times.exchange, times.merge);
+        printf("Largest piece: %lld keys (%.2fx the average)\n", max_count, (double)max_count * size / n);
+        printf("%s\n", ok ? "Output is sorted and holds the input keys" : "Error: output check failed");
+        printf("Execution time: %.6f seconds\n", t_write - t_start);
+    }
+}
+
+// Writes count SplitMix64 keys with collective MPI-IO
+void generate_file(const char* path, long long count, int rank, int size) {
+    long long first = count * rank / size, local = count * (rank + 1) / size - first;
+    long long* keys = (long long*)malloc((local > 0 ? local : 1) * sizeof(long long));
+    fill_keys(keys, first, local);
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, count * 8);
+    file_io(fh, first, keys, local, 1);
+    MPI_File_close(&fh);
+    free(keys);
+
+    if (rank == 0) printf("Wrote %lld int64 keys to %s\n", count, path);
+}
+
+/**
+ * Strong scaling over 1, 2, 4, ... and all processes on 2^log_n keys
+ * generated in memory. Bitonic sort is skipped for process counts that are
+ * not powers of two. Ranks outside the current process count wait on the
+ * barrier.
+ */
+void run_scaling_benchmark(int log_n, int rank, int size) {
+    long long n = 1LL << log_n;
+    double t_one[2] = {0.0, 0.0};
+
+    if (rank == 0) {
+        printf("Strong scaling: 2^%d int64 keys, %d threads per process (times in s, phase maxima over ranks)\n", log_n, omp_get_max_threads());
+        printf("%-6s | %-8s | %-10s | %-10s | %-10s | %-10s | %s\n", "procs", "algo", "local sort", "exchange", "merge", "total", "speedup");
+    }
+    for (int p = 1; p <= size; p = (p * 2 > size && p < size) ? size : p * 2) {
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+
+        if (comm != MPI_COMM_NULL) {
+            long long first = n * rank / p, count = n * (rank + 1) / p - first;
+            for (int algo = 0; algo < 2; algo++) {
+                if (algo == ALGO_BITONIC && (p & (p - 1)) != 0) continue;
+                long long* keys = (long long*)malloc((count > 0 ? count : 1) * sizeof(long long));
+                fill_keys(keys, first, count);
+                unsigned long long input_sum, input_xor;
+                fingerprint(keys, count, &input_sum, &input_xor, comm);
+
+                long long out_count;
+                PhaseTimes times;
+                MPI_Barrier(comm);
+                double t_start = MPI_Wtime();
+                long long* sorted = distributed_sort(algo, keys, count, n, &out_count, comm, &times);
+                double local = MPI_Wtime() - t_start, elapsed;
+                MPI_Allreduce(&local, &elapsed, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+                if (!verify_sorted(sorted, out_count, input_sum, input_xor, n, comm)) {
+                    if (rank == 0) fprintf(stderr, "Error: %s sort check failed on %d processes\n", algo_names[algo], p);
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+                free(sorted);
+                if (p == 1) t_one[algo] = elapsed;
+                if (rank == 0) {
+                    printf("%-6d | %-8s | %-10.4f | %-10.4f | %-10.4f | %-10.4f | %.2fx\n", p, algo_names[algo],
+                           times.local_sort, times.exchange, times.merge, elapsed, t_one[algo] / elapsed);
+                }
+            }
+            MPI_Comm_free(&comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s <bitonic|sample> <in> <out>\n", prog);
+    printf("       %s -g <file> <count>\n", prog);
+    printf("       %s -S [log2_n]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc == 4 && (strcmp(argv[1], algo_names[ALGO_BITONIC]) == 0 || strcmp(argv[1], algo_names[ALGO_SAMPLE]) == 0)) {
+        sort_file(argv[2], argv[3], strcmp(argv[1], algo_names[ALGO_BITONIC]) == 0 ? ALGO_BITONIC : ALGO_SAMPLE, rank, size);
+    } else if (argc == 4 && strcmp(argv[1], "-g") == 0) {
+        long long count = atoll(argv[3]);
+        if (count < 1) {
+            if (rank == 0) printf("Error: count must be positive.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        generate_file(argv[2], count, rank, size);
+    } else if ((argc == 2 || argc == 3) && strcmp(argv[1], "-S") == 0) {
+        int log_n = argc == 3 ? atoi(argv[2]) : 24;
+        if (log_n < 10 || log_n > 30) {
+            if (rank == 0) printf("Error: log2_n must be between 10 and 30.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        run_scaling_benchmark(log_n, rank, size);
+    } else {
+        if (rank == 0) print_usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    MPI_Finalize();
+    return 0;
+}
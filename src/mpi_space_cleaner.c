@@ -65,6 +65,7 @@ void farmer_process(const char* input_str, int num_procs) {
     WorkPackage work;
     Result result;
     MPI_Status status;
+    double start_time = MPI_Wtime();
 
     // Send initial work to workers
     for (int i = 1; i < num_procs; i++) {
@@ -83,6 +84,7 @@ void farmer_process(const char* input_str, int num_procs) {
         strcat(final_result.cleaned, result.cleaned);
         final_result.cleaned_len += result.cleaned_len;
     }
+    double elapsed = MPI_Wtime() - start_time;
 
     // Send termination signal
     for (int i = 1; i < num_procs; i++) {
@@ -91,6 +93,7 @@ void farmer_process(const char* input_str, int num_procs) {
 
     printf("Original string: \"%s\"\n", input_str);
     printf("Cleaned: \"%s\"\n", final_result.cleaned);
+    printf("Execution time: %.6f seconds\n", elapsed);
 }
 
 int main(int argc, char* argv[]) {
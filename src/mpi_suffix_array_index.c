@@ -0,0 +1,787 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: MPI construction of a persistent suffix array (+ LCP) index and batched count/locate queries.
+ */
+
+#define _POSIX_C_SOURCE 200809L // For mmap, open and fstat under -std=c99
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define INDEX_MAGIC "SAIDX01"
+#define HEADER_SIZE 32
+#define MAX_PRINTED_POSITIONS 20
+
+/**
+ * On-disk index layout (all integers native 64-bit, mmap-able as is):
+ *   [0, 32)          header: magic[8], text_len, sa_offset, lcp_offset
+ *   [32, 32 + n)     the text itself, so queries need only the index file
+ *   [sa_offset, +8n) suffix array, suffixes in lexicographic order
+ *   [lcp_offset,+8n) LCP array, lcp[i] = common prefix of sa[i - 1] and sa[i]
+ */
+typedef struct {
+    char magic[8];
+    long long text_len;
+    long long sa_offset;
+    long long lcp_offset;
+} IndexHeader;
+
+#define PACKED_CHARS 7 // Characters packed into each key of the first round (257^7 < 2^63)
+
+// Text being indexed
+const unsigned char* text;
+long long text_len;
+
+/**
+ * Sort record of prefix doubling: the suffix at pos is ordered by the rank
+ * of its first h characters, then by the rank of the h characters after them
+ * (0 past the end of the text), i.e. by its first 2h characters. pos breaks
+ * ties only to balance the buckets of the sample sort.
+ */
+typedef struct {
+    long long key[2];
+    long long pos;
+} SuffixTuple;
+
+int compare_tuples(const SuffixTuple* a, const SuffixTuple* b) {
+    if (a->key[0] != b->key[0]) return a->key[0] < b->key[0] ? -1 : 1;
+    if (a->key[1] != b->key[1]) return a->key[1] < b->key[1] ? -1 : 1;
+    return (a->pos > b->pos) - (a->pos < b->pos);
+}
+
+int qsort_tuples(const void* a, const void* b) {
+    return compare_tuples((const SuffixTuple*)a, (const SuffixTuple*)b);
+}
+
+int same_keys(const SuffixTuple* a, const SuffixTuple* b) {
+    return a->key[0] == b->key[0] && a->key[1] == b->key[1];
+}
+
+/**
+ * Order-preserving code of the PACKED_CHARS characters at pos, in base 257
+ * with 0 for positions past the end, so a proper prefix sorts first.
+ */
+long long packed_prefix(long long pos) {
+    long long code = 0;
+    for (int c = 0; c < PACKED_CHARS; c++) {
+        code = code * 257 + (pos + c < text_len ? text[pos + c] + 1 : 0);
+    }
+    return code;
+}
+
+// Text positions are block distributed: process r owns [block_start(r), block_start(r + 1))
+long long block_start(int r, int size) {
+    return text_len * r / size;
+}
+
+int block_owner(long long pos, int size) {
+    return (int)(((pos + 1) * size - 1) / text_len);
+}
+
+/**
+ * Compares the first m characters of suffix s with the pattern; a suffix
+ * shorter than the pattern that matches it entirely sorts first.
+ */
+int compare_prefix(long long s, const char* pattern, long long m) {
+    long long len = text_len - s < m ? text_len - s : m;
+    int c = memcmp(text + s, pattern, len);
+    if (c != 0) return c;
+    return len < m ? -1 : 0;
+}
+
+// Maps a whole file read-only; returns NULL on failure
+void* map_file(const char* path, long long* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    void* data = (st.st_size > 0) ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    return data == MAP_FAILED ? NULL : data;
+}
+
+/**
+ * Merges the 'runs' sorted runs of a (run r starts at starts[r]) into one sorted
+ * array by repeatedly merging neighbouring runs: O(n log runs) comparisons
+ * instead of sorting the bucket from scratch.
+ */
+void merge_runs(SuffixTuple* a, long long n, int* starts, int runs) {
+    SuffixTuple* tmp = (SuffixTuple*)malloc((n > 0 ? n : 1) * sizeof(SuffixTuple));
+    long long* bounds = (long long*)malloc((runs + 1) * sizeof(long long));
+    for (int r = 0; r < runs; r++) bounds[r] = starts[r];
+    bounds[runs] = n;
+
+    while (runs > 1) {
+        int merged = 0;
+        for (int r = 0; r < runs; r += 2) {
+            long long lo = bounds[r], mid = bounds[r + 1];
+            long long hi = (r + 1 < runs) ? bounds[r + 2] : mid;  // An odd last run is copied as is
+            long long i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) tmp[k++] = (compare_tuples(&a[i], &a[j]) <= 0) ? a[i++] : a[j++];
+            while (i < mid) tmp[k++] = a[i++];
+            while (j < hi) tmp[k++] = a[j++];
+            bounds[merged++] = lo;
+        }
+        bounds[merged] = n;
+        runs = merged;
+        memcpy(a, tmp, n * sizeof(SuffixTuple));
+    }
+
+    free(tmp);
+    free(bounds);
+}
+
+/**
+ * Parallel sample sort of the tuples: each process sorts its own, rank 0
+ * picks p - 1 splitters from regular samples, MPI_Alltoallv sends every tuple
+ * to the process owning its splitter range, and that process merges the
+ * sorted runs it received. Returns this process's bucket.
+ */
+SuffixTuple* sample_sort(SuffixTuple* local, long long local_len, long long* bucket_len,
+                         MPI_Datatype tuple_type, int rank, int size) {
+    qsort(local, local_len, sizeof(SuffixTuple), qsort_tuples);
+
+    // Regular sampling (pos -1 marks a missing sample from a short slice)
+    SuffixTuple* samples = (SuffixTuple*)calloc(size, sizeof(SuffixTuple));
+    for (int i = 0; i < size - 1; i++) {
+        if (local_len > 0) samples[i] = local[(i + 1) * local_len / size];
+        else samples[i].pos = -1;
+    }
+    SuffixTuple* all_samples = NULL;
+    if (rank == 0) all_samples = (SuffixTuple*)malloc((size_t)size * size * sizeof(SuffixTuple));
+    MPI_Gather(samples, size - 1, tuple_type, all_samples, size - 1, tuple_type, 0, MPI_COMM_WORLD);
+
+    // Some process holds text, so there is at least one sample when size > 1
+    SuffixTuple* splitters = (SuffixTuple*)malloc(size * sizeof(SuffixTuple));
+    if (rank == 0) {
+        int num_samples = 0;
+        for (int i = 0; i < size * (size - 1); i++) {
+            if (all_samples[i].pos >= 0) all_samples[num_samples++] = all_samples[i];
+        }
+        qsort(all_samples, num_samples, sizeof(SuffixTuple), qsort_tuples);
+        for (int i = 0; i < size - 1; i++) splitters[i] = all_samples[(long long)(i + 1) * num_samples / size];
+        free(all_samples);
+    }
+    MPI_Bcast(splitters, size - 1, tuple_type, 0, MPI_COMM_WORLD);
+
+    // Bucket b receives the tuples t with splitter[b - 1] < t <= splitter[b]
+    int* send_counts = (int*)calloc(size, sizeof(int));
+    int* recv_counts = (int*)malloc(size * sizeof(int));
+    int* send_displs = (int*)malloc(size * sizeof(int));
+    int* recv_displs = (int*)malloc(size * sizeof(int));
+    for (long long i = 0, b = 0; i < local_len; i++) {
+        while (b < size - 1 && compare_tuples(&local[i], &splitters[b]) > 0) b++;
+        send_counts[b]++;
+    }
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, MPI_COMM_WORLD);
+
+    long long len = 0;
+    for (int i = 0; i < size; i++) {
+        send_displs[i] = (i == 0) ? 0 : send_displs[i - 1] + send_counts[i - 1];
+        recv_displs[i] = (i == 0) ? 0 : recv_displs[i - 1] + recv_counts[i - 1];
+        len += recv_counts[i];
+    }
+    SuffixTuple* bucket = (SuffixTuple*)malloc((len > 0 ? len : 1) * sizeof(SuffixTuple));
+    MPI_Alltoallv(local, send_counts, send_displs, tuple_type,
+                  bucket, recv_counts, recv_displs, tuple_type, MPI_COMM_WORLD);
+    merge_runs(bucket, len, recv_displs, size);
+
+    free(samples);
+    free(splitters);
+    free(send_counts);
+    free(recv_counts);
+    free(send_displs);
+    free(recv_displs);
+    *bucket_len = len;
+    return bucket;
+}
+
+/**
+ * Gives every tuple of the sorted buckets the rank 1 + (global index of the
+ * first tuple with the same keys) in new_ranks. A group of equal keys can
+ * span processes, so the group start carried into this bucket comes from an
+ * MPI_Exscan with MPI_MAX. Returns, on every process, the number of suffixes
+ * that still share their rank with the one before them.
+ */
+long long assign_ranks(const SuffixTuple* bucket, long long bucket_len, long long first, long long* new_ranks,
+                       MPI_Datatype tuple_type, int rank, int size) {
+    // The first tuple is compared with the last one of the previous nonempty bucket
+    SuffixTuple mine = {{0, 0}, -1}, prev = {{0, 0}, -1};
+    if (bucket_len > 0) mine = bucket[bucket_len - 1];
+    SuffixTuple* lasts = (SuffixTuple*)malloc(size * sizeof(SuffixTuple));
+    MPI_Allgather(&mine, 1, tuple_type, lasts, 1, tuple_type, MPI_COMM_WORLD);
+    for (int i = rank - 1; i >= 0 && prev.pos < 0; i--) prev = lasts[i];
+
+    // Group heads get their global index, the other tuples -1
+    long long last_head = -1, group_start, shared = 0, total_shared;
+    for (long long j = 0; j < bucket_len; j++) {
+        const SuffixTuple* before = (j > 0) ? &bucket[j - 1] : (prev.pos >= 0 ? &prev : NULL);
+        if (before && same_keys(before, &bucket[j])) {
+            new_ranks[j] = -1;
+            shared++;
+        } else {
+            new_ranks[j] = last_head = first + j;
+        }
+    }
+    MPI_Exscan(&last_head, &group_start, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+    if (rank == 0) group_start = -1;  // MPI_Exscan leaves rank 0's result undefined
+
+    for (long long j = 0; j < bucket_len; j++) {
+        if (new_ranks[j] >= 0) group_start = new_ranks[j];
+        new_ranks[j] = group_start + 1;
+    }
+    MPI_Allreduce(&shared, &total_shared, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    free(lasts);
+    return total_shared;
+}
+
+/**
+ * Sends one value per bucket entry to the process owning the entry's text
+ * position, as (position, value) pairs. On return *recv holds the pairs this
+ * process received, and slot[j] the index of entry j's pair in the send order,
+ * which is also where the answer to it arrives when the exchange is reversed.
+ */
+long long send_to_owners(const SuffixTuple* bucket, const long long* values, long long bucket_len, long long** recv,
+                         long long* slot, int* send_counts, int* send_displs, int* recv_counts, int* recv_displs,
+                         MPI_Datatype pair_type, int size) {
+    for (int q = 0; q < size; q++) send_counts[q] = 0;
+    for (long long j = 0; j < bucket_len; j++) send_counts[block_owner(bucket[j].pos, size)]++;
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, MPI_COMM_WORLD);
+
+    long long recv_len = 0;
+    int* cursor = (int*)malloc(size * sizeof(int));
+    for (int q = 0; q < size; q++) {
+        send_displs[q] = (q == 0) ? 0 : send_displs[q - 1] + send_counts[q - 1];
+        recv_displs[q] = (q == 0) ? 0 : recv_displs[q - 1] + recv_counts[q - 1];
+        cursor[q] = send_displs[q];
+        recv_len += recv_counts[q];
+    }
+
+    long long* pairs = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * 2 * sizeof(long long));
+    for (long long j = 0; j < bucket_len; j++) {
+        int k = cursor[block_owner(bucket[j].pos, size)]++;
+        if (slot) slot[j] = k;
+        pairs[2 * k] = bucket[j].pos;
+        pairs[2 * k + 1] = values[j];
+    }
+    *recv = (long long*)malloc((recv_len > 0 ? recv_len : 1) * 2 * sizeof(long long));
+    MPI_Alltoallv(pairs, send_counts, send_displs, pair_type,
+                  *recv, recv_counts, recv_displs, pair_type, MPI_COMM_WORLD);
+
+    free(cursor);
+    free(pairs);
+    return recv_len;
+}
+
+/**
+ * Fetches the rank of suffix i + h for every position i of this process (0
+ * past the end of the text). The ranks needed are this block shifted by h,
+ * so every process computes all counts and displacements itself.
+ */
+void shift_ranks(const long long* ranks, long long* shifted, long long h, int rank, int size) {
+    long long lo = block_start(rank, size), hi = block_start(rank + 1, size);
+    int* send_counts = (int*)malloc(size * sizeof(int));
+    int* recv_counts = (int*)malloc(size * sizeof(int));
+    int* send_displs = (int*)malloc(size * sizeof(int));
+    int* recv_displs = (int*)malloc(size * sizeof(int));
+    for (int q = 0; q < size; q++) {
+        long long q_lo = block_start(q, size), q_hi = block_start(q + 1, size);
+
+        // Process q needs [q_lo + h, q_hi + h), and this process [lo + h, hi + h)
+        long long a = lo > q_lo + h ? lo : q_lo + h, b = hi < q_hi + h ? hi : q_hi + h;
+        send_counts[q] = (int)(b > a ? b - a : 0);
+        send_displs[q] = (int)(b > a ? a - lo : 0);
+        a = q_lo > lo + h ? q_lo : lo + h;
+        b = q_hi < hi + h ? q_hi : hi + h;
+        recv_counts[q] = (int)(b > a ? b - a : 0);
+        recv_displs[q] = (int)(b > a ? a - (lo + h) : 0);
+    }
+    memset(shifted, 0, (hi - lo) * sizeof(long long));
+    MPI_Alltoallv((void*)ranks, send_counts, send_displs, MPI_LONG_LONG,
+                  shifted, recv_counts, recv_displs, MPI_LONG_LONG, MPI_COMM_WORLD);
+
+    free(send_counts);
+    free(recv_counts);
+    free(send_displs);
+    free(recv_displs);
+}
+
+/**
+ * LCP array with Kasai's algorithm over the text blocks. Every bucket entry
+ * sends the suffix before it in the suffix array to the owner of its
+ * position. The owner walks its positions in text order: lcp(i) >= lcp(i - 1)
+ * - 1, so each comparison resumes where the previous one stopped and a block
+ * costs O(block length + the LCP at its start). The values travel back along
+ * the reverse route into lcp[], in suffix array order. Returns the largest.
+ */
+long long kasai_lcp(const SuffixTuple* bucket, long long bucket_len, long long* lcp,
+                    MPI_Datatype pair_type, int rank, int size) {
+    long long lo = block_start(rank, size), hi = block_start(rank + 1, size);
+
+    // The first entry's predecessor is the last suffix of the previous nonempty bucket
+    long long my_last = (bucket_len > 0) ? bucket[bucket_len - 1].pos : -1, prev = -1;
+    long long* lasts = (long long*)malloc(size * sizeof(long long));
+    MPI_Allgather(&my_last, 1, MPI_LONG_LONG, lasts, 1, MPI_LONG_LONG, MPI_COMM_WORLD);
+    for (int i = rank - 1; i >= 0 && prev < 0; i--) prev = lasts[i];
+
+    long long* before = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+    for (long long j = 0; j < bucket_len; j++) before[j] = (j > 0) ? bucket[j - 1].pos : prev;
+
+    int* send_counts = (int*)malloc(size * sizeof(int));
+    int* recv_counts = (int*)malloc(size * sizeof(int));
+    int* send_displs = (int*)malloc(size * sizeof(int));
+    int* recv_displs = (int*)malloc(size * sizeof(int));
+    long long* slot = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+    long long* pairs;
+    long long recv_len = send_to_owners(bucket, before, bucket_len, &pairs, slot, send_counts, send_displs,
+                                        recv_counts, recv_displs, pair_type, size);
+
+    // Predecessor in the suffix array of each position of this block (-1 for the smallest suffix)
+    long long* phi = (long long*)malloc((hi > lo ? hi - lo : 1) * sizeof(long long));
+    for (long long k = 0; k < recv_len; k++) phi[pairs[2 * k] - lo] = pairs[2 * k + 1];
+
+    long long* plcp = (long long*)malloc((hi > lo ? hi - lo : 1) * sizeof(long long));
+    for (long long i = lo, h = 0; i < hi; i++) {
+        long long b = phi[i - lo];
+        if (b < 0) {
+            plcp[i - lo] = h = 0;
+            continue;
+        }
+        while (i + h < text_len && b + h < text_len && text[i + h] == text[b + h]) h++;
+        plcp[i - lo] = h;
+        if (h > 0) h--;
+    }
+
+    // Answer in the order the requests arrived, then reverse the exchange
+    long long* answers = (long long*)malloc((recv_len > 0 ? recv_len : 1) * sizeof(long long));
+    long long* replies = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+    for (long long k = 0; k < recv_len; k++) answers[k] = plcp[pairs[2 * k] - lo];
+    MPI_Alltoallv(answers, recv_counts, recv_displs, MPI_LONG_LONG,
+                  replies, send_counts, send_displs, MPI_LONG_LONG, MPI_COMM_WORLD);
+
+    long long local_max = 0, max_lcp;
+    for (long long j = 0; j < bucket_len; j++) {
+        lcp[j] = replies[slot[j]];
+        if (lcp[j] > local_max) local_max = lcp[j];
+    }
+    MPI_Reduce(&local_max, &max_lcp, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    free(lasts);
+    free(before);
+    free(send_counts);
+    free(recv_counts);
+    free(send_displs);
+    free(recv_displs);
+    free(slot);
+    free(pairs);
+    free(phi);
+    free(plcp);
+    free(answers);
+    free(replies);
+    return max_lcp;
+}
+
+/**
+ * Index build: distributed prefix doubling (Manber-Myers) and Kasai's LCP.
+ *   1. Each process keys the suffixes starting in its slice of the text by
+ *      their first 2 * PACKED_CHARS characters.
+ *   2. A sample sort orders all keys, and equal neighbours share a rank that
+ *      now stands for the first 2h characters. Each process fetches the rank
+ *      of suffix i + h for its positions, and the next round sorts by
+ *      (rank(i), rank(i + h)) until all ranks differ: O(log longest repeat)
+ *      rounds of O(n log n) work, however repetitive the text.
+ *   3. The last round's buckets are the suffix array; Kasai's algorithm
+ *      gives the LCP array.
+ *   4. MPI_Exscan gives each bucket's position, and all processes write their
+ *      part of the index with collective MPI-IO.
+ */
+void build_index(const char* text_path, const char* index_path, int rank, int size) {
+    double t_start = MPI_Wtime();
+
+    // Every process maps the text; the page cache shares it between processes on a node
+    long long file_size = 0;
+    text = (const unsigned char*)map_file(text_path, &file_size);
+    if (!text && file_size > 0) {
+        if (rank == 0) fprintf(stderr, "Error: cannot map %s\n", text_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    text_len = file_size;
+    if (text_len == 0) {
+        if (rank == 0) fprintf(stderr, "Error: %s is empty\n", text_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    long long lo = block_start(rank, size), hi = block_start(rank + 1, size);
+    long long local_len = hi - lo;
+    if (local_len > 0x7fffffffLL) {
+        fprintf(stderr, "Error: process %d holds more than 2^31 suffixes, use more processes.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Datatype tuple_type, pair_type;
+    MPI_Type_contiguous(3, MPI_LONG_LONG, &tuple_type);
+    MPI_Type_commit(&tuple_type);
+    MPI_Type_contiguous(2, MPI_LONG_LONG, &pair_type);
+    MPI_Type_commit(&pair_type);
+
+    // Step 1: keys of the first round come straight from the text
+    SuffixTuple* tuples = (SuffixTuple*)malloc((local_len > 0 ? local_len : 1) * sizeof(SuffixTuple));
+    long long* ranks = (long long*)malloc((local_len > 0 ? local_len : 1) * sizeof(long long));
+    long long* shifted = (long long*)malloc((local_len > 0 ? local_len : 1) * sizeof(long long));
+    for (long long i = 0; i < local_len; i++) {
+        tuples[i].key[0] = packed_prefix(lo + i);
+        tuples[i].key[1] = packed_prefix(lo + i + PACKED_CHARS);
+        tuples[i].pos = lo + i;
+    }
+
+    // Step 2: h is the prefix length the ranks stand for after the round's sort
+    SuffixTuple* bucket;
+    long long bucket_len, first;
+    int rounds = 0;
+    for (long long h = 2 * PACKED_CHARS;; h *= 2) {
+        bucket = sample_sort(tuples, local_len, &bucket_len, tuple_type, rank, size);
+        rounds++;
+        first = 0;
+        MPI_Exscan(&bucket_len, &first, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        if (rank == 0) first = 0;  // MPI_Exscan leaves rank 0's result undefined
+
+        long long* new_ranks = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+        long long shared = assign_ranks(bucket, bucket_len, first, new_ranks, tuple_type, rank, size);
+        if (shared == 0) {
+            free(new_ranks);
+            break;
+        }
+
+        // New ranks go back to the owners of the positions, which pair them with the ranks h further on
+        long long* pairs;
+        int* counts = (int*)malloc(4 * size * sizeof(int));
+        long long recv_len = send_to_owners(bucket, new_ranks, bucket_len, &pairs, NULL, counts, counts + size,
+                                            counts + 2 * size, counts + 3 * size, pair_type, size);
+        for (long long k = 0; k < recv_len; k++) ranks[pairs[2 * k] - lo] = pairs[2 * k + 1];
+        free(counts);
+        free(pairs);
+        free(new_ranks);
+        free(bucket);
+
+        shift_ranks(ranks, shifted, h, rank, size);
+        for (long long i = 0; i < local_len; i++) {
+            tuples[i].key[0] = ranks[i];
+            tuples[i].key[1] = shifted[i];
+            tuples[i].pos = lo + i;
+        }
+    }
+    free(tuples);
+    free(ranks);
+    free(shifted);
+    double t_sort = MPI_Wtime();
+
+    // Step 3: suffix array slice and LCP values of this bucket
+    long long* sa = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+    long long* lcp = (long long*)malloc((bucket_len > 0 ? bucket_len : 1) * sizeof(long long));
+    for (long long j = 0; j < bucket_len; j++) sa[j] = bucket[j].pos;
+    long long max_lcp = kasai_lcp(bucket, bucket_len, lcp, pair_type, rank, size);
+    free(bucket);
+    double t_lcp = MPI_Wtime();
+
+    // Step 4: write header, text slice, SA slice and LCP slice
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.text_len = text_len;
+    header.sa_offset = (HEADER_SIZE + text_len + 7) / 8 * 8;
+    header.lcp_offset = header.sa_offset + text_len * (long long)sizeof(long long);
+
+    if (bucket_len * (long long)sizeof(long long) > 0x7fffffffLL) {
+        fprintf(stderr, "Error: process %d holds more than 2 GiB of index data, use more processes.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, index_path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", index_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, header.lcp_offset + text_len * (long long)sizeof(long long));
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    MPI_File_write_at_all(fh, HEADER_SIZE + lo, (void*)(text + lo), (int)local_len, MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, header.sa_offset + first * (long long)sizeof(long long), sa,
+                          (int)bucket_len, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, header.lcp_offset + first * (long long)sizeof(long long), lcp,
+                          (int)bucket_len, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    double t_end = MPI_Wtime();
+
+    // Per-phase timings of the slowest process
+    double phases[3] = {t_sort - t_start, t_lcp - t_sort, t_end - t_lcp};
+    double max_phases[3];
+    MPI_Reduce(phases, max_phases, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    long long max_bucket;
+    MPI_Reduce(&bucket_len, &max_bucket, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        printf("Indexed %lld bytes with %d processes into %s\n", text_len, size, index_path);
+        printf("Largest bucket: %lld suffixes (ideal %lld)\n", max_bucket, (text_len + size - 1) / size);
+        printf("Longest repeated substring: %lld bytes\n", max_lcp);
+        printf("Prefix doubling: %.6f s (%d rounds) | LCP: %.6f s | write: %.6f s\n",
+               max_phases[0], rounds, max_phases[1], max_phases[2]);
+        printf("Execution time: %.6f seconds\n", t_end - t_start);
+    }
+
+    free(sa);
+    free(lcp);
+    MPI_Type_free(&tuple_type);
+    MPI_Type_free(&pair_type);
+    munmap((void*)text, text_len);
+}
+
+/**
+ * Count/locate: two binary searches over the suffix array give the range
+ * [*first, *last) of suffixes starting with the pattern, in O(m log n).
+ */
+void find_range(const long long* sa, const char* pattern, long long m, long long* first, long long* last) {
+    long long lo = 0, hi = text_len;
+    while (lo < hi) {  // First suffix >= pattern
+        long long mid = lo + (hi - lo) / 2;
+        if (compare_prefix(sa[mid], pattern, m) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *first = lo;
+    hi = text_len;
+    while (lo < hi) {  // First suffix > pattern (as a prefix)
+        long long mid = lo + (hi - lo) / 2;
+        if (compare_prefix(sa[mid], pattern, m) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *last = lo;
+}
+
+/**
+ * Writes the k smallest of the count positions in sa (k <= count) to best in
+ * increasing order, by insertion into a sorted array of k entries: one pass,
+ * O(count * k) worst case, without copying or sorting all occurrences.
+ */
+void smallest_positions(const long long* sa, long long count, long long* best, int k) {
+    int len = 0;
+    for (long long i = 0; i < count; i++) {
+        long long x = sa[i];
+        if (len == k && x >= best[k - 1]) continue;
+        int j = (len < k) ? len++ : k - 1;
+        while (j > 0 && best[j - 1] > x) {
+            best[j] = best[j - 1];
+            j--;
+        }
+        best[j] = x;
+    }
+}
+
+/**
+ * Reads one query per line (trailing '\r' and empty lines are ignored).
+ * Returns the number of queries; *buffer holds them NUL-separated.
+ */
+int read_queries(const char* path, char** buffer, long* buffer_len) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    fseek(file, 0, SEEK_END);
+    long fsize = ftell(file);
+    rewind(file);
+
+    char* buf = (char*)malloc(fsize + 1);
+    if (fread(buf, 1, fsize, file) != (size_t)fsize) {
+        fprintf(stderr, "Error: cannot read %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    fclose(file);
+
+    // Compact into NUL-separated, non-empty queries
+    long out = 0;
+    int count = 0;
+    for (long i = 0, begin = 0; i <= fsize; i++) {
+        if (i < fsize && buf[i] != '\n') continue;
+        long end = i;
+        if (end > begin && buf[end - 1] == '\r') end--;
+        if (end > begin) {
+            memmove(buf + out, buf + begin, end - begin);
+            out += end - begin;
+            buf[out++] = '\0';
+            count++;
+        }
+        begin = i + 1;
+    }
+
+    *buffer = buf;
+    *buffer_len = out;
+    return count;
+}
+
+/**
+ * Query mode: every process maps the index, the batch of queries is split
+ * into contiguous blocks, and each process answers its block. Results are
+ * gathered as text on rank 0 and printed in query order.
+ */
+void query_index(const char* index_path, char* queries, long queries_len, int num_queries, int locate, int rank, int size) {
+    double t_start = MPI_Wtime();
+
+    long long index_size = 0;
+    const char* index = (const char*)map_file(index_path, &index_size);
+    const IndexHeader* header = (const IndexHeader*)index;
+    if (!index || index_size < HEADER_SIZE || memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        if (rank == 0) fprintf(stderr, "Error: %s is not a suffix array index\n", index_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    text = (const unsigned char*)index + HEADER_SIZE;
+    text_len = header->text_len;
+    const long long* sa = (const long long*)(index + header->sa_offset);
+    double t_setup = MPI_Wtime();
+
+    // Locate the queries assigned to this process
+    char** list = (char**)malloc((num_queries > 0 ? num_queries : 1) * sizeof(char*));
+    for (long i = 0, q = 0; i < queries_len; i += strlen(queries + i) + 1) list[q++] = queries + i;
+    int q_first = (int)((long long)num_queries * rank / size);
+    int q_last = (int)((long long)num_queries * (rank + 1) / size);
+
+    size_t cap = 4096, len = 0;
+    char* out = (char*)malloc(cap);
+    long long local_hits = 0;
+    for (int q = q_first; q < q_last; q++) {
+        long long first, last;
+        find_range(sa, list[q], (long long)strlen(list[q]), &first, &last);
+        local_hits += last - first;
+
+        long long shown = (locate && last - first < MAX_PRINTED_POSITIONS) ? last - first : (locate ? MAX_PRINTED_POSITIONS : 0);
+        size_t need = strlen(list[q]) + 64 + (size_t)shown * 21;
+        if (len + need > cap) {
+            while (len + need > cap) cap *= 2;
+            out = (char*)realloc(out, cap);
+        }
+        len += sprintf(out + len, "%s: %lld", list[q], last - first);
+        if (locate && last > first) {
+            // Suffix array order is lexicographic; report the first positions in text order
+            long long positions[MAX_PRINTED_POSITIONS];
+            smallest_positions(sa + first, last - first, positions, (int)shown);
+            len += sprintf(out + len, " at");
+            for (long long i = 0; i < shown; i++) len += sprintf(out + len, " %lld", positions[i]);
+            if (shown < last - first) len += sprintf(out + len, " ...");
+        }
+        out[len++] = '\n';
+    }
+    double t_query = MPI_Wtime();
+
+    // Gather the formatted answers on rank 0 in rank (= query) order
+    int my_len = (int)len;
+    int* lens = NULL;
+    int* displs = NULL;
+    char* all = NULL;
+    if (rank == 0) {
+        lens = (int*)malloc(size * sizeof(int));
+        displs = (int*)malloc(size * sizeof(int));
+    }
+    MPI_Gather(&my_len, 1, MPI_INT, lens, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        long total = 0;
+        for (int i = 0; i < size; i++) {
+            displs[i] = (int)total;
+            total += lens[i];
+        }
+        all = (char*)malloc(total + 1);
+        all[total] = '\0';
+    }
+    MPI_Gatherv(out, my_len, MPI_CHAR, all, lens, displs, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    long long hits;
+    double times[3] = {t_setup - t_start, t_query - t_setup, t_query - t_start}, max_times[3];
+    MPI_Reduce(&local_hits, &hits, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(times, max_times, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        fputs(all, stdout);
+        printf("%d queries, %lld occurrences in %lld bytes of text\n", num_queries, hits, text_len);
+        printf("Index setup: %.6f s | queries: %.6f s (%.2f us per query)\n",
+               max_times[0], max_times[1], num_queries > 0 ? max_times[1] * 1e6 / num_queries : 0.0);
+        printf("Execution time: %.6f seconds\n", max_times[2]);
+        free(lens);
+        free(displs);
+        free(all);
+    }
+
+    free(list);
+    free(out);
+    munmap((void*)index, index_size);
+}
+
+void print_usage(const char* prog) {
+    fprintf(stderr, "Usage: %s build <text_file> <index_file>\n", prog);
+    fprintf(stderr, "       %s query <index_file> [-l] <pattern>...\n", prog);
+    fprintf(stderr, "       %s query <index_file> [-l] -q <query_file>\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc == 4 && strcmp(argv[1], "build") == 0) {
+        build_index(argv[2], argv[3], rank, size);
+    } else if (argc >= 4 && strcmp(argv[1], "query") == 0) {
+        int argi = 3, locate = 0;
+        if (strcmp(argv[argi], "-l") == 0) {
+            locate = 1;
+            argi++;
+        }
+
+        // Rank 0 collects the batch of queries and broadcasts it
+        char* queries = NULL;
+        long queries_len = 0;
+        int num_queries = 0;
+        if (rank == 0) {
+            if (argi + 1 < argc && strcmp(argv[argi], "-q") == 0) {
+                num_queries = read_queries(argv[argi + 1], &queries, &queries_len);
+            } else {
+                for (int i = argi; i < argc; i++) queries_len += strlen(argv[i]) + 1;
+                queries = (char*)malloc(queries_len > 0 ? queries_len : 1);
+                queries_len = 0;
+                for (int i = argi; i < argc; i++) {
+                    if (argv[i][0] == '\0') continue;
+                    strcpy(queries + queries_len, argv[i]);
+                    queries_len += strlen(argv[i]) + 1;
+                    num_queries++;
+                }
+            }
+            if (num_queries == 0 || queries_len != (long)(int)queries_len) {
+                print_usage(argv[0]);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+        }
+        MPI_Bcast(&num_queries, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&queries_len, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+        if (rank != 0) queries = (char*)malloc(queries_len);
+        MPI_Bcast(queries, (int)queries_len, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+        query_index(argv[2], queries, queries_len, num_queries, locate, rank, size);
+        free(queries);
+    } else {
+        if (rank == 0) print_usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    MPI_Finalize();
+    return 0;
+}
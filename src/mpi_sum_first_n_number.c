@@ -1,83 +1,645 @@
 /*
  * Author: canetizen
  * Created on Sun May 25 2025
- * Description: MPI implementation for sum of the first n number.
- */ 
+ * Description: Hybrid MPI+OpenMP reduction and scan engine (sum of the first n numbers, reductions and prefix scans over binary files).
+ */
+
+#define _POSIX_C_SOURCE 200809L // For mmap, open and fstat under -std=c99
 
 #include <mpi.h>
+#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-int main(int argc, char* argv[]) {
-    int rank, size;
+#define LANES 8              // Independent Kahan accumulators, one per SIMD lane
+#define PAIRWISE_BLOCK 256   // Base case of the pairwise summation
+#define MAX_THREADS 1024
 
-    MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+enum { TYPE_INT64, TYPE_DOUBLE };
+enum { OP_SUM, OP_MIN, OP_MAX, OP_KAHAN, OP_PAIRWISE };
 
-    int info[2]; // [0] = start, [1] = chunk
+const char* type_names[] = {"int64", "double"};
+const char* op_names[] = {"sum", "min", "max", "kahan", "pairwise"};
 
-    if (rank == 0) {
-        if (argc != 2) {
-            printf("Usage: %s <n>\n", argv[0]);
-            MPI_Abort(MPI_COMM_WORLD, 1);
+// Running sum plus the low-order bits lost so far (compensated summation)
+typedef struct {
+    double sum;
+    double comp;
+} CompensatedSum;
+
+// Neumaier's variant of Kahan summation: also correct when |x| > |sum|
+void neumaier_add(CompensatedSum* acc, double x) {
+    double t = acc->sum + x;
+    if ((acc->sum >= 0 ? acc->sum : -acc->sum) >= (x >= 0 ? x : -x)) {
+        acc->comp += (acc->sum - t) + x;
+    } else {
+        acc->comp += (x - t) + acc->sum;
+    }
+    acc->sum = t;
+}
+
+// MPI user operation combining the compensated partial sums of different ranks
+void compensated_op(void* in, void* inout, int* len, MPI_Datatype* type) {
+    (void)type;
+    CompensatedSum* a = (CompensatedSum*)in;
+    CompensatedSum* b = (CompensatedSum*)inout;
+    for (int i = 0; i < *len; i++) {
+        CompensatedSum acc = b[i];
+        neumaier_add(&acc, a[i].sum);
+        neumaier_add(&acc, a[i].comp);
+        b[i] = acc;
+    }
+}
+
+/**
+ * Kahan summation vectorized across LANES independent accumulators; each
+ * thread sums a static block and the per-thread results are combined in
+ * thread order, so the result does not depend on scheduling.
+ */
+CompensatedSum kahan_sum(const double* x, long long n) {
+    CompensatedSum partial[MAX_THREADS];
+    int num_threads = 1;
+    long long blocks = n / LANES;
+
+    #pragma omp parallel
+    {
+        double s[LANES] = {0}, c[LANES] = {0};
+
+        #pragma omp for schedule(static)
+        for (long long b = 0; b < blocks; b++) {
+            #pragma omp simd
+            for (int l = 0; l < LANES; l++) {
+                double y = x[b * LANES + l] - c[l];
+                double t = s[l] + y;
+                c[l] = (t - s[l]) - y;
+                s[l] = t;
+            }
         }
 
-        int n = atoi(argv[1]);
-        if (n % size != 0) {
-            printf("Error: n must be divisible by the number of processes.\n");
-            MPI_Abort(MPI_COMM_WORLD, 1);
+        CompensatedSum acc = {0.0, 0.0};
+        for (int l = 0; l < LANES; l++) {
+            neumaier_add(&acc, s[l]);
+            neumaier_add(&acc, -c[l]);
         }
+        int t = omp_get_thread_num();
+        if (t < MAX_THREADS) partial[t] = acc;
+        #pragma omp single
+        num_threads = omp_get_num_threads();
+    }
+
+    CompensatedSum total = {0.0, 0.0};
+    for (int t = 0; t < num_threads && t < MAX_THREADS; t++) {
+        neumaier_add(&total, partial[t].sum);
+        neumaier_add(&total, partial[t].comp);
+    }
+    for (long long i = blocks * LANES; i < n; i++) neumaier_add(&total, x[i]);
+    return total;
+}
+
+// Pairwise (cascade) summation: O(log n) error growth with plain SIMD blocks
+double pairwise_sum(const double* x, long long n) {
+    if (n <= PAIRWISE_BLOCK) {
+        double s = 0.0;
+        #pragma omp simd reduction(+:s)
+        for (long long i = 0; i < n; i++) s += x[i];
+        return s;
+    }
+    long long half = n / 2;
+    return pairwise_sum(x, half) + pairwise_sum(x + half, n - half);
+}
 
-        int chunk = n / size;
+// Every thread sums one contiguous block pairwise; the blocks are summed pairwise too
+double parallel_pairwise_sum(const double* x, long long n) {
+    double partial[MAX_THREADS];
+    int num_threads = 1;
 
-        // Prepare start/chunk pairs for each process
-        int* sendbuf = (int*)malloc(2 * size * sizeof(int));
-        for (int i = 0; i < size; i++) {
-            sendbuf[2 * i]     = i * chunk + 1; // start
-            sendbuf[2 * i + 1] = chunk;         // chunk
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        long long lo = n * t / nt, hi = n * (t + 1) / nt;
+        if (t < MAX_THREADS) partial[t] = pairwise_sum(x + lo, hi - lo);
+        #pragma omp single
+        num_threads = nt < MAX_THREADS ? nt : MAX_THREADS;
+    }
+    return pairwise_sum(partial, num_threads);
+}
+
+/**
+ * Maps elements [first, first + count) of a binary file. mmap offsets must be
+ * page aligned, so the mapping starts at the enclosing page; *base and
+ * *map_len describe the whole mapping for munmap.
+ */
+const void* map_range(const char* path, long long first_byte, long long bytes, void** base, size_t* map_len) {
+    *base = NULL;
+    *map_len = 0;
+    if (bytes == 0) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    long page = sysconf(_SC_PAGESIZE);
+    long long aligned = first_byte / page * page;
+    *map_len = (size_t)(first_byte - aligned + bytes);
+    void* data = mmap(NULL, *map_len, PROT_READ, MAP_PRIVATE, fd, (off_t)aligned);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    *base = data;
+    return (const char*)data + (first_byte - aligned);
+}
+
+/**
+ * File mode: every rank maps its own (possibly uneven) slice of the file,
+ * reduces it with OpenMP SIMD loops, and a single MPI_Reduce combines the ranks.
+ */
+void reduce_file(const char* path, int type, int op, int rank, int size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    long long n = (long long)st.st_size / 8;  // Both element types are 8 bytes wide
+    long long first = n * rank / size, last = n * (rank + 1) / size;
+    long long count = last - first;
+
+    void* base;
+    size_t map_len;
+    const void* data = map_range(path, first * 8, count * 8, &base, &map_len);
+    if (count > 0 && data == NULL) {
+        fprintf(stderr, "Error: rank %d cannot map %s\n", rank, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_start = MPI_Wtime();
+
+    if (type == TYPE_INT64) {
+        const long long* x = (const long long*)data;
+        long long local, global;
+        if (op == OP_MIN) {
+            local = LLONG_MAX;
+            #pragma omp parallel for simd reduction(min:local)
+            for (long long i = 0; i < count; i++) local = x[i] < local ? x[i] : local;
+            MPI_Reduce(&local, &global, 1, MPI_LONG_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+        } else if (op == OP_MAX) {
+            local = LLONG_MIN;
+            #pragma omp parallel for simd reduction(max:local)
+            for (long long i = 0; i < count; i++) local = x[i] > local ? x[i] : local;
+            MPI_Reduce(&local, &global, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+        } else {
+            local = 0;
+            #pragma omp parallel for simd reduction(+:local)
+            for (long long i = 0; i < count; i++) local += x[i];
+            MPI_Reduce(&local, &global, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        }
+        if (rank == 0) printf("%s = %lld\n", op_names[op], global);
+    } else {
+        const double* x = (const double*)data;
+        double local, global;
+        if (op == OP_KAHAN) {
+            MPI_Datatype pair_type;
+            MPI_Op pair_op;
+            MPI_Type_contiguous(2, MPI_DOUBLE, &pair_type);
+            MPI_Type_commit(&pair_type);
+            MPI_Op_create(compensated_op, 1, &pair_op);
+
+            CompensatedSum local_sum = kahan_sum(x, count), global_sum;
+            MPI_Reduce(&local_sum, &global_sum, 1, pair_type, pair_op, 0, MPI_COMM_WORLD);
+            global = global_sum.sum + global_sum.comp;
+
+            MPI_Op_free(&pair_op);
+            MPI_Type_free(&pair_type);
+        } else if (op == OP_PAIRWISE) {
+            local = parallel_pairwise_sum(x, count);
+            MPI_Reduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        } else if (op == OP_MIN) {
+            local = DBL_MAX;
+            #pragma omp parallel for simd reduction(min:local)
+            for (long long i = 0; i < count; i++) local = x[i] < local ? x[i] : local;
+            MPI_Reduce(&local, &global, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+        } else if (op == OP_MAX) {
+            local = -DBL_MAX;
+            #pragma omp parallel for simd reduction(max:local)
+            for (long long i = 0; i < count; i++) local = x[i] > local ? x[i] : local;
+            MPI_Reduce(&local, &global, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        } else {
+            local = 0.0;
+            #pragma omp parallel for simd reduction(+:local)
+            for (long long i = 0; i < count; i++) local += x[i];
+            MPI_Reduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
         }
+        if (rank == 0) printf("%s = %.17g\n", op_names[op], global);
+    }
+
+    double elapsed = MPI_Wtime() - t_start;
+    if (rank == 0) {
+        printf("Reduced %lld %s values with %d processes x %d threads (%.3f GB/s)\n",
+               n, type_names[type], size, omp_get_max_threads(), n * 8.0 / elapsed / 1e9);
+        printf("Execution time: %.6f seconds\n", elapsed);
+    }
 
-        // Scatter [start, chunk] pairs
-        MPI_Scatter(sendbuf, 2, MPI_INT,
-                    info, 2, MPI_INT,
-                    0, MPI_COMM_WORLD);
+    if (base) munmap(base, map_len);
+}
+
+/**
+ * Associative scan operators: name, combination of a and b, and identity for
+ * int64 and double. An operator is defined only here. The generated
+ * ScanOperator entry gives the local scans and the MPI user operation the
+ * same combine function, and the command line finds it by name.
+ */
+#define SCAN_OPERATORS(X)                                       \
+    X(sum, (a) + (b), 0, 0.0)                                   \
+    X(min, ((b) < (a) ? (b) : (a)), LLONG_MAX, DBL_MAX)         \
+    X(max, ((b) > (a) ? (b) : (a)), LLONG_MIN, -DBL_MAX)
+
+/**
+ * Blocked three-phase scan of one rank's chunk, generated for each operator and element type:
+ *   1. every thread reduces its block with LANES independent accumulators (vectorized),
+ *   2. one thread scans the block totals into block offsets,
+ *   3. every thread scans its block again, starting from its block offset.
+ * Returns the combination of the whole chunk, which is what MPI_Exscan needs.
+ * add_offset_* is the final vectorized pass that applies the rank offset in place.
+ */
+#define DEFINE_SCAN(T, SUFFIX, NAME, ID)                                            \
+T scan_##NAME##_##SUFFIX(T* x, long long n, int exclusive) {                        \
+    T id = ID;                                                                      \
+    T block_total[MAX_THREADS + 1];                                                 \
+    int max_threads = omp_get_max_threads();                                        \
+    int num_threads = max_threads < MAX_THREADS ? max_threads : MAX_THREADS;        \
+                                                                                    \
+    _Pragma("omp parallel num_threads(num_threads)")                                \
+    {                                                                               \
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();                   \
+        long long lo = n * t / nt, hi = n * (t + 1) / nt, i = lo;                   \
+                                                                                    \
+        T lane[LANES];                                                              \
+        for (int l = 0; l < LANES; l++) lane[l] = id;                               \
+        for (; i + LANES <= hi; i += LANES) {                                       \
+            _Pragma("omp simd")                                                     \
+            for (int l = 0; l < LANES; l++) lane[l] = combine_##NAME##_##SUFFIX(lane[l], x[i + l]); \
+        }                                                                           \
+        T acc = id;                                                                 \
+        for (int l = 0; l < LANES; l++) acc = combine_##NAME##_##SUFFIX(acc, lane[l]); \
+        for (; i < hi; i++) acc = combine_##NAME##_##SUFFIX(acc, x[i]);             \
+        block_total[t + 1] = acc;                                                   \
+                                                                                    \
+        _Pragma("omp barrier")                                                      \
+        _Pragma("omp single")                                                       \
+        {                                                                           \
+            block_total[0] = id;                                                    \
+            for (int b = 1; b <= nt; b++) {                                         \
+                block_total[b] = combine_##NAME##_##SUFFIX(block_total[b - 1], block_total[b]); \
+            }                                                                       \
+            num_threads = nt;                                                       \
+        }                                                                           \
+                                                                                    \
+        T run = block_total[t];                                                     \
+        if (exclusive) {                                                            \
+            for (i = lo; i < hi; i++) {                                             \
+                T v = x[i];                                                         \
+                x[i] = run;                                                         \
+                run = combine_##NAME##_##SUFFIX(run, v);                            \
+            }                                                                       \
+        } else {                                                                    \
+            for (i = lo; i < hi; i++) {                                             \
+                run = combine_##NAME##_##SUFFIX(run, x[i]);                         \
+                x[i] = run;                                                         \
+            }                                                                       \
+        }                                                                           \
+    }                                                                               \
+    return block_total[num_threads];                                                \
+}                                                                                   \
+                                                                                    \
+void add_offset_##NAME##_##SUFFIX(T* x, long long n, T offset) {                    \
+    _Pragma("omp parallel for simd")                                                \
+    for (long long i = 0; i < n; i++) x[i] = combine_##NAME##_##SUFFIX(offset, x[i]); \
+}
+
+// Combine functions, scans and the MPI user operation of one operator
+#define DEFINE_SCAN_OPERATOR(NAME, EXPR, ID_INT64, ID_DOUBLE)                       \
+static inline long long combine_##NAME##_int64(long long a, long long b) { return EXPR; } \
+static inline double combine_##NAME##_double(double a, double b) { return EXPR; } \
+DEFINE_SCAN(long long, int64, NAME, ID_INT64)                                       \
+DEFINE_SCAN(double, double, NAME, ID_DOUBLE)                                        \
+                                                                                    \
+/* MPI user operation, so ranks combine with exactly the local function */         \
+void mpi_##NAME(void* in, void* inout, int* len, MPI_Datatype* type) {              \
+    if (*type == MPI_DOUBLE) {                                                      \
+        double *a = (double*)in, *b = (double*)inout;                               \
+        for (int i = 0; i < *len; i++) b[i] = combine_##NAME##_double(a[i], b[i]);  \
+    } else {                                                                        \
+        long long *a = (long long*)in, *b = (long long*)inout;                      \
+        for (int i = 0; i < *len; i++) b[i] = combine_##NAME##_int64(a[i], b[i]);   \
+    }                                                                               \
+}
+
+SCAN_OPERATORS(DEFINE_SCAN_OPERATOR)
 
-        free(sendbuf);
+// Scan operator as seen by scan_chunk: one entry per line of SCAN_OPERATORS
+typedef struct {
+    const char* name;
+    long long (*scan_int64)(long long* x, long long n, int exclusive);
+    void (*add_offset_int64)(long long* x, long long n, long long offset);
+    double (*scan_double)(double* x, long long n, int exclusive);
+    void (*add_offset_double)(double* x, long long n, double offset);
+    MPI_User_function* mpi_function;
+} ScanOperator;
+
+#define SCAN_OPERATOR_ENTRY(NAME, EXPR, ID_INT64, ID_DOUBLE) \
+    {#NAME, scan_##NAME##_int64, add_offset_##NAME##_int64, scan_##NAME##_double, add_offset_##NAME##_double, mpi_##NAME},
+
+const ScanOperator scan_operators[] = {SCAN_OPERATORS(SCAN_OPERATOR_ENTRY)};
+const int num_scan_operators = sizeof(scan_operators) / sizeof(scan_operators[0]);
+
+/**
+ * Scans a chunk in place as part of a global scan over comm: local three-phase
+ * scan, MPI_Exscan of the chunk totals, then the offset pass. MPI_Exscan leaves
+ * rank 0's result undefined, and rank 0 needs no offset anyway.
+ */
+void scan_chunk(void* data, long long count, int type, const ScanOperator* op, int exclusive, MPI_Comm comm) {
+    int rank;
+    MPI_Op mpi_op;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Op_create(op->mpi_function, 1, &mpi_op);
+
+    if (type == TYPE_INT64) {
+        long long total = op->scan_int64((long long*)data, count, exclusive), offset;
+        MPI_Exscan(&total, &offset, 1, MPI_LONG_LONG, mpi_op, comm);
+        if (rank > 0) op->add_offset_int64((long long*)data, count, offset);
     } else {
-        // Receive [start, chunk]
-        MPI_Scatter(NULL, 2, MPI_INT,
-                    info, 2, MPI_INT,
-                    0, MPI_COMM_WORLD);
+        double total = op->scan_double((double*)data, count, exclusive), offset;
+        MPI_Exscan(&total, &offset, 1, MPI_DOUBLE, mpi_op, comm);
+        if (rank > 0) op->add_offset_double((double*)data, count, offset);
     }
 
-    int my_start = info[0];
-    int chunk = info[1];
-    int my_end = my_start + chunk - 1;
+    MPI_Op_free(&mpi_op);
+}
 
-    // Compute local sum
-    int local_sum = 0;
-    for (int i = my_start; i <= my_end; i++) {
-        local_sum += i;
+/**
+ * File scan mode: every rank reads its uneven slice with collective MPI-IO,
+ * scans it and writes the result at the same offset of the output file.
+ */
+void scan_file(const char* in_path, const char* out_path, int type, const ScanOperator* op, int exclusive, int rank, int size) {
+    MPI_Datatype elem = type == TYPE_INT64 ? MPI_LONG_LONG : MPI_DOUBLE;
+    MPI_File fh;
+    MPI_Offset file_size;
+
+    if (MPI_File_open(MPI_COMM_WORLD, in_path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s\n", in_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
     }
+    MPI_File_get_size(fh, &file_size);
+    long long n = (long long)file_size / 8;
+    long long first = n * rank / size, last = n * (rank + 1) / size;
+    long long count = last - first;
+    if (count > INT_MAX) {
+        fprintf(stderr, "Error: rank %d would hold more than %d values, use more processes.\n", rank, INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    void* data = malloc((count > 0 ? count : 1) * 8);
+    double t_start = MPI_Wtime();
+    MPI_File_read_at_all(fh, first * 8, data, (int)count, elem, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_read = MPI_Wtime();
+    scan_chunk(data, count, type, op, exclusive, MPI_COMM_WORLD);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_scan = MPI_Wtime();
+
+    if (MPI_File_open(MPI_COMM_WORLD, out_path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", out_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, n * 8);
+    MPI_File_write_at_all(fh, first * 8, data, (int)count, elem, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    double t_write = MPI_Wtime();
+    free(data);
 
-    // Gather local sums to root
-    int* local_sums = NULL;
     if (rank == 0) {
-        local_sums = (int*)malloc(size * sizeof(int));
+        printf("%s %s scan of %lld %s values with %d processes x %d threads\n",
+               exclusive ? "Exclusive" : "Inclusive", op->name, n, type_names[type], size, omp_get_max_threads());
+        printf("Read: %.6f s | scan: %.6f s (%.3f GB/s) | write: %.6f s\n",
+               t_read - t_start, t_scan - t_read, n * 8.0 / (t_scan - t_read) / 1e9, t_write - t_scan);
+        printf("Execution time: %.6f seconds\n", t_write - t_start);
+    }
+}
+
+// Best of three in-place inclusive int64 sum scans of count ones per rank of comm
+double time_scan(long long total, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    long long first = total * rank / size, count = total * (rank + 1) / size - first;
+    long long* x = (long long*)malloc((count > 0 ? count : 1) * sizeof(long long));
+    double best = 0.0;
+
+    for (int rep = 0; rep < 3; rep++) {
+        #pragma omp parallel for simd
+        for (long long i = 0; i < count; i++) x[i] = 1;
+
+        MPI_Barrier(comm);
+        double t_start = MPI_Wtime();
+        scan_chunk(x, count, TYPE_INT64, &scan_operators[0], 0, comm);
+        double local = MPI_Wtime() - t_start, elapsed;
+        MPI_Allreduce(&local, &elapsed, 1, MPI_DOUBLE, MPI_MAX, comm);
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    // The inclusive scan of ones is the 1-based global index
+    if (count > 0 && x[count - 1] != first + count) {
+        fprintf(stderr, "Error: scan check failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    free(x);
+    return best;
+}
+
+/**
+ * Scaling benchmark over 1, 2, 4, ... and all processes. Strong scaling keeps
+ * the total size fixed; weak scaling keeps total / np values per process.
+ * Ranks outside the current process count wait on the barrier.
+ */
+void run_scan_benchmark(long long total, int rank, int size) {
+    long long per_rank = total / size;
+
+    for (int weak = 0; weak < 2; weak++) {
+        if (rank == 0) {
+            if (weak) printf("\nWeak scaling: %lld int64 values per process\n", per_rank);
+            else printf("Strong scaling: %lld int64 values\n", total);
+            printf("%-6s | %-10s | %-8s | %s\n", "procs", "time (s)", "GB/s", "efficiency");
+        }
+
+        double t_one = 0.0;
+        for (int p = 1; p <= size; p = (p * 2 > size && p < size) ? size : p * 2) {
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+            long long n = weak ? per_rank * p : total;
+
+            if (comm != MPI_COMM_NULL) {
+                double t = time_scan(n, comm);
+                if (p == 1) t_one = t;
+                if (rank == 0) {
+                    double efficiency = weak ? t_one / t : t_one / (p * t);
+                    printf("%-6d | %-10.6f | %-8.3f | %.2f\n", p, t, n * 8.0 / t / 1e9, efficiency);
+                }
+                MPI_Comm_free(&comm);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+}
+
+/**
+ * Writes count deterministic pseudo-random values with collective MPI-IO, so
+ * test inputs of any size can be produced in parallel. Doubles span many
+ * magnitudes to make the difference between summation methods visible.
+ */
+void generate_file(const char* path, int type, long long count, int rank, int size) {
+    long long first = count * rank / size, last = count * (rank + 1) / size;
+    long long local = last - first;
+    if (local * 8 > INT_MAX) {
+        fprintf(stderr, "Error: rank %d would write more than 2 GiB, use more processes.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    long long* buf = (long long*)malloc((local > 0 ? local : 1) * 8);
+    double* dbuf = (double*)buf;
+    #pragma omp parallel for
+    for (long long i = 0; i < local; i++) {
+        // SplitMix64 of the global index: the file is the same for any process count
+        unsigned long long z = (unsigned long long)(first + i) * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        if (type == TYPE_INT64) {
+            buf[i] = (long long)(z % 2000001) - 1000000;
+        } else {
+            double unit = (z >> 11) * (1.0 / 9007199254740992.0);        // [0, 1)
+            double scale = (double)(1ULL << (z & 31)) / 65536.0;          // 2^-16 .. 2^15
+            dbuf[i] = (unit - 0.5) * scale;
+        }
+    }
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
     }
+    MPI_File_set_size(fh, count * 8);
+    MPI_File_write_at_all(fh, first * 8, buf, (int)(local * 8), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    free(buf);
+
+    if (rank == 0) printf("Wrote %lld %s values to %s\n", count, type_names[type], path);
+}
+
+/**
+ * Closed-form demo: sum of 1..n. Each rank sums its own (uneven) range with an
+ * OpenMP SIMD reduction in 64-bit, and a single MPI_Reduce adds the ranks.
+ */
+void sum_first_n(long long n, int rank, int size) {
+    long long first = n * rank / size + 1, last = n * (rank + 1) / size;
 
-    MPI_Gather(&local_sum, 1, MPI_INT,
-               local_sums, 1, MPI_INT,
-               0, MPI_COMM_WORLD);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_start = MPI_Wtime();
+
+    long long local_sum = 0, total_sum;
+    #pragma omp parallel for simd reduction(+:local_sum)
+    for (long long i = first; i <= last; i++) {
+        local_sum += i;
+    }
+    MPI_Reduce(&local_sum, &total_sum, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
+    double elapsed = MPI_Wtime() - t_start;
     if (rank == 0) {
-        int total_sum = 0;
-        for (int i = 0; i < size; i++) {
-            total_sum += local_sums[i];
+        printf("Sum of the first %lld positive integers is %lld (%d processes x %d threads)\n", n, total_sum, size,
+               omp_get_max_threads());
+        printf("Execution time: %.6f seconds\n", elapsed);
+    }
+}
+
+int parse_name(const char* name, const char* names[], int count) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(name, names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s <n>\n", prog);
+    printf("       %s -f <file> <int64|double> <sum|min|max|kahan|pairwise>\n", prog);
+    printf("       %s -s <in> <out> <int64|double> <inclusive|exclusive> [sum|min|max]\n", prog);
+    printf("       %s -S [million_values]\n", prog);
+    printf("       %s -g <file> <int64|double> <count>\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "-S") == 0) {
+        long long total = (argc == 3 ? atoll(argv[2]) : 16) * 1000000LL;
+        if (total < size) {
+            if (rank == 0) printf("Error: the benchmark needs at least one value per process.\n");
+            MPI_Finalize();
+            return 1;
+        }
+        run_scan_benchmark(total, rank, size);
+    } else if ((argc == 6 || argc == 7) && strcmp(argv[1], "-s") == 0) {
+        int type = parse_name(argv[4], type_names, 2);
+        int exclusive = strcmp(argv[5], "exclusive") == 0;
+        int op = -1;
+        for (int i = 0; i < num_scan_operators; i++) {
+            if (strcmp(argc == 7 ? argv[6] : "sum", scan_operators[i].name) == 0) op = i;
+        }
+        if (type < 0 || op < 0 || (!exclusive && strcmp(argv[5], "inclusive") != 0)) {
+            if (rank == 0) print_usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+        scan_file(argv[2], argv[3], type, &scan_operators[op], exclusive, rank, size);
+    } else if (argc == 2) {
+        long long n = atoll(argv[1]);
+        // n(n + 1) / 2 must fit in a signed 64-bit integer
+        if (n < 1 || n > 4294967295LL) {
+            if (rank == 0) printf("Error: n must be between 1 and 4294967295.\n");
+            MPI_Finalize();
+            return 1;
         }
-        printf("Sum of the first %d positive integers is %d\n", chunk * size, total_sum);
-        free(local_sums);
+        sum_first_n(n, rank, size);
+    } else if (argc == 5 && (strcmp(argv[1], "-f") == 0 || strcmp(argv[1], "-g") == 0)) {
+        int type = parse_name(argv[3], type_names, 2);
+        if (type < 0) {
+            if (rank == 0) print_usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+        if (argv[1][1] == 'g') {
+            generate_file(argv[2], type, atoll(argv[4]), rank, size);
+        } else {
+            int op = parse_name(argv[4], op_names, 5);
+            if (op < 0 || (type == TYPE_INT64 && op >= OP_KAHAN)) {
+                if (rank == 0) printf("Error: kahan and pairwise apply to double values only.\n");
+                MPI_Finalize();
+                return 1;
+            }
+            reduce_file(argv[2], type, op, rank, size);
+        }
+    } else {
+        if (rank == 0) print_usage(argv[0]);
+        MPI_Finalize();
+        return 1;
     }
 
     MPI_Finalize();
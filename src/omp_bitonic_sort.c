@@ -1,13 +1,16 @@
 /*
  * Author: canetizen
  * Created on Fri May 23 2025
- * Description: Iterative Bitonic Sort using OpenMP.
+ * Description: Iterative and task-recursive Bitonic Sort using OpenMP (any length, generic key/value).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
 
+#include "omp_bitonic_sort.h"
+
 // Compare and swap two elements if they are out of order based on dir (1 = ascending, 0 = descending)
 void compare_and_swap(int* arr, int i, int j, int dir) {
     if ((dir && arr[i] > arr[j]) || (!dir && arr[i] < arr[j])) {
@@ -37,13 +40,271 @@ void bitonic_sort_iterative(int* arr, int n, int dir) {
     }
 }
 
-int main() {
-    // Example array (must be power of 2 in length)
-    int arr[] = {10, 30, 11, 20, 4, 330, 21, 110};
+// Merge stages of the iterative network: sorts a bitonic sequence of n (a power of 2) elements
+void bitonic_merge_iterative(int* arr, int n, int dir) {
+    for (int stride = n >> 1; stride > 0; stride >>= 1) {
+        for (int i = 0; i < n; i++) {
+            int j = i ^ stride;
+            if (j > i) compare_and_swap(arr, i, j, dir);
+        }
+    }
+}
+
+// Returns 1 if arr is sorted in ascending order
+int is_sorted(const int* arr, int n) {
+    for (int i = 1; i < n; i++) {
+        if (arr[i - 1] > arr[i]) return 0;
+    }
+    return 1;
+}
+
+// Times the iterative and the task-recursive version on 2^log_n random ints
+void run_benchmark(int log_n) {
+    int n = 1 << log_n;
+    int* input = (int*)malloc((size_t)n * sizeof(int));
+    int* arr = (int*)malloc((size_t)n * sizeof(int));
+    srand(42);
+    for (int i = 0; i < n; i++) input[i] = rand();
+
+    printf("Sorting 2^%d = %d random ints with %d threads\n", log_n, n, omp_get_max_threads());
+    double times[2];
+    for (int v = 0; v < 2; v++) {
+        for (int i = 0; i < n; i++) arr[i] = input[i];
+        double start = omp_get_wtime();
+        if (v == 0) {
+            bitonic_sort_iterative(arr, n, 1);
+        } else {
+            bitonic_sort_int32(arr, NULL, n, 1);
+        }
+        times[v] = omp_get_wtime() - start;
+        if (!is_sorted(arr, n)) {
+            printf("Error: %s result is not sorted\n", v ? "recursive" : "iterative");
+            exit(1);
+        }
+    }
+    printf("Iterative: %.3f s\n", times[0]);
+    printf("Recursive: %.3f s (%.1fx faster)\n", times[1], times[0] / times[1]);
+    printf("Execution time: %.6f seconds\n", times[0] + times[1]);
+
+    free(input);
+    free(arr);
+}
+
+// xorshift64* generator for benchmark keys
+unsigned long long next_random(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * Key/value benchmark, generated per key type: bitonic_sort_X with the
+ * original indices as payload against qsort on an array of (key, payload)
+ * records. The result is checked through the payload: keys must be sorted
+ * and every key must be the input key at its payload index.
+ */
+#define DEFINE_PAIR_BENCHMARK(T, SUFFIX, RANDOM_KEY)                                          \
+typedef struct {                                                                              \
+    T key;                                                                                    \
+    long long payload;                                                                        \
+} Pair_##SUFFIX;                                                                              \
+                                                                                              \
+int compare_pairs_##SUFFIX(const void* a, const void* b) {                                    \
+    T x = ((const Pair_##SUFFIX*)a)->key, y = ((const Pair_##SUFFIX*)b)->key;                 \
+    return (x > y) - (x < y);                                                                 \
+}                                                                                             \
+                                                                                              \
+void benchmark_pairs_##SUFFIX(long long n) {                                                  \
+    T* input = (T*)malloc(n * sizeof(T));                                                     \
+    T* keys = (T*)malloc(n * sizeof(T));                                                      \
+    long long* payload = (long long*)malloc(n * sizeof(long long));                           \
+    unsigned long long state = 42;                                                            \
+    for (long long i = 0; i < n; i++) {                                                       \
+        unsigned long long r = next_random(&state);                                           \
+        input[i] = (RANDOM_KEY);                                                              \
+        keys[i] = input[i];                                                                   \
+        payload[i] = i;                                                                       \
+    }                                                                                         \
+                                                                                              \
+    double start = omp_get_wtime();                                                           \
+    bitonic_sort_##SUFFIX(keys, payload, n, 1);                                               \
+    double bitonic_time = omp_get_wtime() - start;                                            \
+    for (long long i = 0; i < n; i++) {                                                       \
+        if ((i > 0 && keys[i - 1] > keys[i]) || payload[i] < 0 || payload[i] >= n ||          \
+            input[payload[i]] != keys[i]) {                                                   \
+            printf("Error: bitonic result is wrong at %lld\n", i);                            \
+            exit(1);                                                                          \
+        }                                                                                     \
+    }                                                                                         \
+    free(keys);                                                                               \
+    free(payload);                                                                            \
+                                                                                              \
+    Pair_##SUFFIX* pairs = (Pair_##SUFFIX*)malloc(n * sizeof(Pair_##SUFFIX));                 \
+    for (long long i = 0; i < n; i++) {                                                       \
+        pairs[i].key = input[i];                                                              \
+        pairs[i].payload = i;                                                                 \
+    }                                                                                         \
+    start = omp_get_wtime();                                                                  \
+    qsort(pairs, n, sizeof(Pair_##SUFFIX), compare_pairs_##SUFFIX);                           \
+    double qsort_time = omp_get_wtime() - start;                                              \
+    free(pairs);                                                                              \
+    free(input);                                                                              \
+                                                                                              \
+    printf("Sorting %lld %s key/value pairs with %d threads\n", n, #SUFFIX, omp_get_max_threads()); \
+    printf("qsort: %.3f s (bitonic speedup %.2fx)\n", qsort_time, qsort_time / bitonic_time);   \
+    printf("Execution time: %.6f seconds\n", bitonic_time);                                   \
+}
+
+DEFINE_PAIR_BENCHMARK(int, int32, (int)(r >> 32))
+DEFINE_PAIR_BENCHMARK(long long, int64, (long long)r)
+DEFINE_PAIR_BENCHMARK(float, float, (float)((double)(r >> 11) / 9007199254740992.0 * 2e6 - 1e6))
+DEFINE_PAIR_BENCHMARK(double, double, (double)(r >> 11) / 9007199254740992.0 * 2e6 - 1e6)
+
+/**
+ * Vector kernel benchmark on 2^log_n ints: ns per element of the block sort,
+ * the block merge and the whole sort, for every SIMD kernel this CPU
+ * supports, with the speedup over scalar. The scalar row is the existing
+ * compare_and_swap network: bitonic_sort_iterative on every block and on the
+ * whole array, and its merge stages for the block merge.
+ */
+void run_kernel_benchmark(int log_n) {
+    const char* names[3] = {"scalar", "avx2", "avx512"};
+    const int widths[3] = {0, 8, 16};
+    int detected = simd_width;
+    long long n = 1LL << log_n;
+    int* input = (int*)malloc(n * sizeof(int));
+    int* bitonic = (int*)malloc(n * sizeof(int));
+    int* arr = (int*)malloc(n * sizeof(int));
+    srand(42);
+    for (long long i = 0; i < n; i++) input[i] = rand();
+
+    // Merge input: every block is an ascending half followed by a descending half
+    simd_width = 0;
+    for (long long i = 0; i < n; i++) bitonic[i] = input[i];
+    for (long long b = 0; b < n; b += BASE_BLOCK) {
+        sort_block_int32(bitonic + b, NULL, BASE_BLOCK / 2, 1);
+        sort_block_int32(bitonic + b + BASE_BLOCK / 2, NULL, BASE_BLOCK / 2, 0);
+    }
+
+    printf("Sorting 2^%d ints with %d threads, blocks of %d (ns per element)\n", log_n, omp_get_max_threads(), BASE_BLOCK);
+    printf("%-8s %12s %12s %12s\n", "kernel", "block sort", "block merge", "full sort");
+    double scalar[3] = {0, 0, 0};
+    for (int level = 0; level < 3; level++) {
+        if (widths[level] > detected) continue;
+        simd_width = widths[level];
+        double ns[3];
+        for (int phase = 0; phase < 3; phase++) {
+            const int* source = phase == 1 ? bitonic : input;
+            for (long long i = 0; i < n; i++) arr[i] = source[i];
+            double start = omp_get_wtime();
+            if (level == 0 && phase == 2) {
+                bitonic_sort_iterative(arr, (int)n, 1);
+            } else if (level == 0) {
+                #pragma omp parallel for schedule(static)
+                for (long long b = 0; b < n; b += BASE_BLOCK) {
+                    if (phase == 0) {
+                        bitonic_sort_iterative(arr + b, BASE_BLOCK, 1);
+                    } else {
+                        bitonic_merge_iterative(arr + b, BASE_BLOCK, 1);
+                    }
+                }
+            } else if (phase == 2) {
+                bitonic_sort_int32(arr, NULL, n, 1);
+            } else {
+                #pragma omp parallel for schedule(static)
+                for (long long b = 0; b < n; b += BASE_BLOCK) {
+                    if (phase == 0) {
+                        sort_block_int32(arr + b, NULL, BASE_BLOCK, 1);
+                    } else {
+                        merge_block_int32(arr + b, NULL, BASE_BLOCK, 1);
+                    }
+                }
+            }
+            ns[phase] = (omp_get_wtime() - start) / n * 1e9;
+            for (long long i = 1; i < n; i++) {
+                if (arr[i - 1] > arr[i] && (phase == 2 || i % BASE_BLOCK != 0)) {
+                    printf("Error: %s %s result is not sorted at %lld\n", names[level], phase == 0 ? "block sort" : phase == 1 ? "block merge" : "full sort", i);
+                    exit(1);
+                }
+            }
+        }
+        if (level == 0) {
+            for (int phase = 0; phase < 3; phase++) scalar[phase] = ns[phase];
+        }
+        printf("%-8s", names[level]);
+        for (int phase = 0; phase < 3; phase++) printf(" %6.2f (%.1fx)", ns[phase], scalar[phase] / ns[phase]);
+        printf("\n");
+    }
+
+    simd_width = detected;
+    free(input);
+    free(bitonic);
+    free(arr);
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s\n", prog);
+    printf("       %s <log2_n>\n", prog);
+    printf("       %s -p <int32|int64|float|double> [n]\n", prog);
+    printf("       %s -v <log2_n>\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    simd_width = detect_simd_width();
+
+    if (argc == 3 && strcmp(argv[1], "-v") == 0) {
+        int log_n = atoi(argv[2]);
+        if (log_n < 15 || log_n > 30) {
+            printf("Error: log2(n) must be between 15 and 30.\n");
+            return 1;
+        }
+        run_kernel_benchmark(log_n);
+        return 0;
+    }
+
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "-p") == 0) {
+        long long n = argc == 4 ? atoll(argv[3]) : 100000000LL;
+        if (n < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[2], "int32") == 0) {
+            benchmark_pairs_int32(n);
+        } else if (strcmp(argv[2], "int64") == 0) {
+            benchmark_pairs_int64(n);
+        } else if (strcmp(argv[2], "float") == 0) {
+            benchmark_pairs_float(n);
+        } else if (strcmp(argv[2], "double") == 0) {
+            benchmark_pairs_double(n);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc == 2) {
+        int log_n = atoi(argv[1]);
+        if (log_n < 1 || log_n > 30) {
+            printf("Error: log2(n) must be between 1 and 30.\n");
+            return 1;
+        }
+        run_benchmark(log_n);
+        return 0;
+    }
+
+    if (argc != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Example array (any length works)
+    int arr[] = {10, 30, 11, 20, 4, 330, 21, 110, 7, 55};
     int n = sizeof(arr) / sizeof(arr[0]);
 
     // Bitonic sort in ascending order
-    bitonic_sort_iterative(arr, n, 1);
+    bitonic_sort_int32(arr, NULL, n, 1);
 
     // Output result
     printf("Sorted array:\n");
@@ -0,0 +1,397 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: Generic key/value bitonic sort with AVX2/AVX-512 int32 kernels, shared by omp_bitonic_sort and omp_sort_benchmark.
+ */
+
+#ifndef OMP_BITONIC_SORT_H
+#define OMP_BITONIC_SORT_H
+
+// Every program is built from one source file, so the sorts are defined here rather than in a library.
+// Everything is static, so several translation units of one program can include this header.
+
+#include <stdlib.h>
+#include <omp.h>
+
+#define BASE_BLOCK (1 << 15)   // Elements sorted or merged sequentially (128 KB of int keys, fits in L2)
+#define INSERTION_CUTOFF 16    // Quicksort hands smaller ranges to insertion sort
+
+/**
+ * In-register bitonic networks for int32 keys. A vector holds 8 (AVX2) or 16
+ * (AVX-512) keys; every compare/exchange stage permutes the vector against
+ * itself (lane ^ stride), takes min and max and blends them by lane. Strides
+ * of at least one vector are min/max between two vectors. The kernels are
+ * compiled with target attributes and picked at runtime, so the same binary
+ * falls back to the scalar path on CPUs without AVX2.
+ */
+static int simd_width = 0;  // Lanes of the active kernel: 0 (scalar), 8 (AVX2) or 16 (AVX-512)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/*
+ * One in-register stage (stride j inside a sequence of size k) for the keys at
+ * block positions pos: the lower lane of a pair keeps the minimum when its
+ * size-k sequence is ascending, i.e. when (pos & k) == 0 matches dir.
+ */
+__attribute__((target("avx2")))
+static inline __m256i avx2_stage(__m256i v, __m256i pos, int j, long long k, int dir) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i perm = _mm256_and_si256(_mm256_xor_si256(pos, _mm256_set1_epi32(j)), _mm256_set1_epi32(7));
+    __m256i p = _mm256_permutevar8x32_epi32(v, perm);
+    __m256i upper = _mm256_cmpgt_epi32(_mm256_and_si256(pos, _mm256_set1_epi32(j)), zero);
+    __m256i asc = _mm256_cmpeq_epi32(_mm256_and_si256(pos, _mm256_set1_epi32((int)k)), zero);
+    if (!dir) asc = _mm256_xor_si256(asc, _mm256_set1_epi32(-1));
+    // Plain and/andnot select: gcc 12 -O3 mis-folds blendv once dir is constant-propagated
+    __m256i take_min = _mm256_xor_si256(upper, asc);
+    return _mm256_or_si256(_mm256_and_si256(take_min, _mm256_min_epi32(v, p)), _mm256_andnot_si256(take_min, _mm256_max_epi32(v, p)));
+}
+
+// Stride j >= 8 between vectors; the whole run [x, x + j) shares one direction
+__attribute__((target("avx2")))
+static inline void avx2_cross(int* a, long long x, long long j, int asc) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + x));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(a + x + j));
+    if (asc) {
+        _mm256_storeu_si256((__m256i*)(a + x), _mm256_min_epi32(va, vb));
+        _mm256_storeu_si256((__m256i*)(a + x + j), _mm256_max_epi32(va, vb));
+    } else {
+        _mm256_storeu_si256((__m256i*)(a + x), _mm256_max_epi32(va, vb));
+        _mm256_storeu_si256((__m256i*)(a + x + j), _mm256_min_epi32(va, vb));
+    }
+}
+
+// Full bitonic sort of a power-of-two block (n >= 8)
+__attribute__((target("avx2")))
+static inline void avx2_sort_block(int* a, long long n, int dir) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    // Sequences of up to 8 keys are sorted entirely in registers
+    for (long long x = 0; x < n; x += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + x));
+        __m256i pos = _mm256_add_epi32(lanes, _mm256_set1_epi32((int)x));
+        for (long long k = 2; k <= 8; k <<= 1) {
+            for (int j = (int)(k >> 1); j > 0; j >>= 1) v = avx2_stage(v, pos, j, k < n ? k : 0, dir);
+        }
+        _mm256_storeu_si256((__m256i*)(a + x), v);
+    }
+    for (long long k = 16; k <= n; k <<= 1) {
+        long long dk = k < n ? k : 0;  // The final sequence has the requested direction everywhere
+        for (long long j = k >> 1; j >= 8; j >>= 1) {
+            for (long long i = 0; i < n; i += 2 * j) {
+                int asc = ((i & dk) == 0) == dir;
+                for (long long o = 0; o < j; o += 8) avx2_cross(a, i + o, j, asc);
+            }
+        }
+        // The last three strides of every vector in one load/store
+        for (long long x = 0; x < n; x += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(a + x));
+            __m256i pos = _mm256_add_epi32(lanes, _mm256_set1_epi32((int)x));
+            for (int j = 4; j > 0; j >>= 1) v = avx2_stage(v, pos, j, dk, dir);
+            _mm256_storeu_si256((__m256i*)(a + x), v);
+        }
+    }
+}
+
+// Bitonic merge of a power-of-two block (n >= 8) into direction dir
+__attribute__((target("avx2")))
+static inline void avx2_merge_block(int* a, long long n, int dir) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (long long j = n >> 1; j >= 8; j >>= 1) {
+        for (long long i = 0; i < n; i += 2 * j) {
+            for (long long o = 0; o < j; o += 8) avx2_cross(a, i + o, j, dir);
+        }
+    }
+    for (long long x = 0; x < n; x += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + x));
+        __m256i pos = _mm256_add_epi32(lanes, _mm256_set1_epi32((int)x));
+        for (int j = 4; j > 0; j >>= 1) v = avx2_stage(v, pos, j, 0, dir);
+        _mm256_storeu_si256((__m256i*)(a + x), v);
+    }
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i avx512_stage(__m512i v, __m512i pos, int j, long long k, int dir) {
+    __m512i perm = _mm512_and_si512(_mm512_xor_si512(pos, _mm512_set1_epi32(j)), _mm512_set1_epi32(15));
+    __m512i p = _mm512_permutexvar_epi32(perm, v);
+    __mmask16 upper = _mm512_test_epi32_mask(pos, _mm512_set1_epi32(j));
+    __mmask16 asc = _mm512_testn_epi32_mask(pos, _mm512_set1_epi32((int)k));
+    if (!dir) asc = (__mmask16)~asc;
+    return _mm512_mask_blend_epi32((__mmask16)(upper ^ asc), _mm512_max_epi32(v, p), _mm512_min_epi32(v, p));
+}
+
+__attribute__((target("avx512f")))
+static inline void avx512_cross(int* a, long long x, long long j, int asc) {
+    __m512i va = _mm512_loadu_si512((const void*)(a + x));
+    __m512i vb = _mm512_loadu_si512((const void*)(a + x + j));
+    __m512i mn = _mm512_min_epi32(va, vb), mx = _mm512_max_epi32(va, vb);
+    _mm512_storeu_si512((void*)(a + x), asc ? mn : mx);
+    _mm512_storeu_si512((void*)(a + x + j), asc ? mx : mn);
+}
+
+// Same network as avx2_sort_block with 16 lanes (n >= 16)
+__attribute__((target("avx512f")))
+static inline void avx512_sort_block(int* a, long long n, int dir) {
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (long long x = 0; x < n; x += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(a + x));
+        __m512i pos = _mm512_add_epi32(lanes, _mm512_set1_epi32((int)x));
+        for (long long k = 2; k <= 16; k <<= 1) {
+            for (int j = (int)(k >> 1); j > 0; j >>= 1) v = avx512_stage(v, pos, j, k < n ? k : 0, dir);
+        }
+        _mm512_storeu_si512((void*)(a + x), v);
+    }
+    for (long long k = 32; k <= n; k <<= 1) {
+        long long dk = k < n ? k : 0;
+        for (long long j = k >> 1; j >= 16; j >>= 1) {
+            for (long long i = 0; i < n; i += 2 * j) {
+                int asc = ((i & dk) == 0) == dir;
+                for (long long o = 0; o < j; o += 16) avx512_cross(a, i + o, j, asc);
+            }
+        }
+        for (long long x = 0; x < n; x += 16) {
+            __m512i v = _mm512_loadu_si512((const void*)(a + x));
+            __m512i pos = _mm512_add_epi32(lanes, _mm512_set1_epi32((int)x));
+            for (int j = 8; j > 0; j >>= 1) v = avx512_stage(v, pos, j, dk, dir);
+            _mm512_storeu_si512((void*)(a + x), v);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static inline void avx512_merge_block(int* a, long long n, int dir) {
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (long long j = n >> 1; j >= 16; j >>= 1) {
+        for (long long i = 0; i < n; i += 2 * j) {
+            for (long long o = 0; o < j; o += 16) avx512_cross(a, i + o, j, dir);
+        }
+    }
+    for (long long x = 0; x < n; x += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(a + x));
+        __m512i pos = _mm512_add_epi32(lanes, _mm512_set1_epi32((int)x));
+        for (int j = 8; j > 0; j >>= 1) v = avx512_stage(v, pos, j, 0, dir);
+        _mm512_storeu_si512((void*)(a + x), v);
+    }
+}
+
+// Widest kernel the CPU supports
+static inline int detect_simd_width(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return 16;
+    if (__builtin_cpu_supports("avx2")) return 8;
+    return 0;
+}
+#else
+static inline void avx2_sort_block(int* a, long long n, int dir) { (void)a; (void)n; (void)dir; }
+static inline void avx2_merge_block(int* a, long long n, int dir) { (void)a; (void)n; (void)dir; }
+static inline void avx512_sort_block(int* a, long long n, int dir) { (void)a; (void)n; (void)dir; }
+static inline void avx512_merge_block(int* a, long long n, int dir) { (void)a; (void)n; (void)dir; }
+static inline int detect_simd_width(void) { return 0; }
+#endif
+
+// SIMD hooks of the generic sort: return 1 when the block was handled (int32, power of two, no payload)
+static inline int simd_sort_block_int32(int* keys, long long n, int dir) {
+    if (simd_width == 0 || n < simd_width || (n & (n - 1)) != 0) return 0;
+    if (simd_width == 16) {
+        avx512_sort_block(keys, n, dir);
+    } else {
+        avx2_sort_block(keys, n, dir);
+    }
+    return 1;
+}
+
+static inline int simd_merge_block_int32(int* keys, long long n, int dir) {
+    if (simd_width == 0 || n < simd_width || (n & (n - 1)) != 0) return 0;
+    if (simd_width == 16) {
+        avx512_merge_block(keys, n, dir);
+    } else {
+        avx2_merge_block(keys, n, dir);
+    }
+    return 1;
+}
+
+// Other key types use the scalar path
+#define NO_SIMD_KERNELS(T, SUFFIX)                                                             \
+static inline int simd_sort_block_##SUFFIX(T* keys, long long n, int dir) { (void)keys; (void)n; (void)dir; return 0; } \
+static inline int simd_merge_block_##SUFFIX(T* keys, long long n, int dir) { (void)keys; (void)n; (void)dir; return 0; }
+
+NO_SIMD_KERNELS(long long, int64)
+NO_SIMD_KERNELS(float, float)
+NO_SIMD_KERNELS(double, double)
+
+/**
+ * Generic key/value bitonic sort, generated once per key type so every
+ * compare/swap is a branch-free min/max on that type. payload is optional
+ * (NULL for keys only); when given, payload[i] moves together with keys[i],
+ * e.g. record offsets or the original indices. Any length works: the halves
+ * of an odd-sized range differ by one, and the merge compares across the
+ * largest power of two below the length (Lang's bitonic merge for arbitrary
+ * n), so no padding is needed. NaN keys are not supported.
+ *
+ * Generated names: quick_sort_X, sort_block_X, merge_step_X, merge_block_X,
+ * bitonic_merge_X, bitonic_sort_task_X and the entry point bitonic_sort_X.
+ */
+#define DEFINE_BITONIC_SORT(T, SUFFIX)                                                        \
+static inline void swap_##SUFFIX(T* keys, long long* payload, long long i, long long j) {     \
+    T t = keys[i];                                                                            \
+    keys[i] = keys[j];                                                                        \
+    keys[j] = t;                                                                              \
+    if (payload) {                                                                            \
+        long long u = payload[i];                                                             \
+        payload[i] = payload[j];                                                              \
+        payload[j] = u;                                                                       \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+static inline void insertion_sort_##SUFFIX(T* keys, long long* payload, long long n) {        \
+    for (long long i = 1; i < n; i++) {                                                       \
+        T v = keys[i];                                                                        \
+        long long pv = payload ? payload[i] : 0, j = i - 1;                                   \
+        while (j >= 0 && keys[j] > v) {                                                       \
+            keys[j + 1] = keys[j];                                                            \
+            if (payload) payload[j + 1] = payload[j];                                         \
+            j--;                                                                              \
+        }                                                                                     \
+        keys[j + 1] = v;                                                                      \
+        if (payload) payload[j + 1] = pv;                                                     \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+/* Sequential quicksort (median of three, insertion sort for short ranges), ascending */      \
+static inline void quick_sort_##SUFFIX(T* keys, long long* payload, long long n) {            \
+    while (n > INSERTION_CUTOFF) {                                                            \
+        long long mid = n / 2;                                                                \
+        /* Order the first, middle and last keys so the median sits at mid */                \
+        if (keys[mid] < keys[0]) swap_##SUFFIX(keys, payload, mid, 0);                        \
+        if (keys[n - 1] < keys[0]) swap_##SUFFIX(keys, payload, n - 1, 0);                    \
+        if (keys[n - 1] < keys[mid]) swap_##SUFFIX(keys, payload, n - 1, mid);                \
+        T pivot = keys[mid];                                                                  \
+                                                                                              \
+        long long i = 0, j = n - 1;                                                           \
+        while (i <= j) {                                                                      \
+            while (keys[i] < pivot) i++;                                                      \
+            while (keys[j] > pivot) j--;                                                      \
+            if (i <= j) swap_##SUFFIX(keys, payload, i++, j--);                               \
+        }                                                                                     \
+        /* Recurse into the smaller side, loop on the larger one */                           \
+        if (j + 1 < n - i) {                                                                  \
+            quick_sort_##SUFFIX(keys, payload, j + 1);                                        \
+            keys += i;                                                                        \
+            if (payload) payload += i;                                                        \
+            n -= i;                                                                           \
+        } else {                                                                              \
+            quick_sort_##SUFFIX(keys + i, payload ? payload + i : NULL, n - i);               \
+            n = j + 1;                                                                        \
+        }                                                                                     \
+    }                                                                                         \
+    insertion_sort_##SUFFIX(keys, payload, n);                                                \
+}                                                                                             \
+                                                                                              \
+/* Base case: sorts a cache-sized block sequentially in the requested direction */            \
+static inline void sort_block_##SUFFIX(T* keys, long long* payload, long long n, int dir) {   \
+    if (payload == NULL && simd_sort_block_##SUFFIX(keys, n, dir)) return;                    \
+    quick_sort_##SUFFIX(keys, payload, n);                                                    \
+    if (!dir) {                                                                               \
+        for (long long i = 0, j = n - 1; i < j; i++, j--) swap_##SUFFIX(keys, payload, i, j); \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+/* One merge step: keys[i] and keys[i + dist] are ordered without branches */                 \
+static inline void merge_step_##SUFFIX(T* keys, long long* payload, long long count, long long dist, int dir) { \
+    if (payload) {                                                                            \
+        for (long long i = 0; i < count; i++) {                                               \
+            T a = keys[i], b = keys[i + dist];                                                \
+            long long pa = payload[i], pb = payload[i + dist];                                \
+            int swap = dir ? b < a : a < b;                                                   \
+            keys[i] = swap ? b : a;                                                           \
+            keys[i + dist] = swap ? a : b;                                                    \
+            payload[i] = swap ? pb : pa;                                                      \
+            payload[i + dist] = swap ? pa : pb;                                               \
+        }                                                                                     \
+    } else {                                                                                  \
+        for (long long i = 0; i < count; i++) {                                               \
+            T a = keys[i], b = keys[i + dist];                                                \
+            T lo = a < b ? a : b, hi = a < b ? b : a;                                         \
+            keys[i] = dir ? lo : hi;                                                          \
+            keys[i + dist] = dir ? hi : lo;                                                   \
+        }                                                                                     \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+/* Merges a bitonic range that fits in cache, sequentially; powers of two go stride by stride */ \
+static inline void merge_block_##SUFFIX(T* keys, long long* payload, long long n, int dir) {  \
+    if (payload == NULL && simd_merge_block_##SUFFIX(keys, n, dir)) return;                   \
+    if ((n & (n - 1)) == 0) {                                                                 \
+        for (long long half = n >> 1; half > 0; half >>= 1) {                                 \
+            for (long long lo = 0; lo < n; lo += 2 * half) {                                  \
+                merge_step_##SUFFIX(keys + lo, payload ? payload + lo : NULL, half, half, dir); \
+            }                                                                                 \
+        }                                                                                     \
+        return;                                                                               \
+    }                                                                                         \
+    if (n <= INSERTION_CUTOFF) {                                                              \
+        insertion_sort_##SUFFIX(keys, payload, n);                                            \
+        if (!dir) {                                                                           \
+            for (long long i = 0, j = n - 1; i < j; i++, j--) swap_##SUFFIX(keys, payload, i, j); \
+        }                                                                                     \
+        return;                                                                               \
+    }                                                                                         \
+    long long m = largest_power_of_two_below(n);                                              \
+    merge_step_##SUFFIX(keys, payload, n - m, m, dir);                                        \
+    merge_block_##SUFFIX(keys, payload, m, dir);                                              \
+    merge_block_##SUFFIX(keys + m, payload ? payload + m : NULL, n - m, dir);                 \
+}                                                                                             \
+                                                                                              \
+/* Only strides wider than a block pass over the range, in block-sized tasks */               \
+static inline void bitonic_merge_##SUFFIX(T* keys, long long* payload, long long n, int dir) { \
+    if (n <= BASE_BLOCK) {                                                                    \
+        merge_block_##SUFFIX(keys, payload, n, dir);                                          \
+        return;                                                                               \
+    }                                                                                         \
+    long long m = largest_power_of_two_below(n);                                              \
+    _Pragma("omp taskloop grainsize(1)")                                                      \
+    for (long long i = 0; i < n - m; i += BASE_BLOCK) {                                       \
+        merge_step_##SUFFIX(keys + i, payload ? payload + i : NULL,                           \
+                            BASE_BLOCK < n - m - i ? BASE_BLOCK : n - m - i, m, dir);         \
+    }                                                                                         \
+    _Pragma("omp task")                                                                       \
+    bitonic_merge_##SUFFIX(keys, payload, m, dir);                                            \
+    _Pragma("omp task")                                                                       \
+    bitonic_merge_##SUFFIX(keys + m, payload ? payload + m : NULL, n - m, dir);               \
+    _Pragma("omp taskwait")                                                                   \
+}                                                                                             \
+                                                                                              \
+/* Halves sorted in opposite directions form a bitonic sequence */                            \
+static inline void bitonic_sort_task_##SUFFIX(T* keys, long long* payload, long long n, int dir) { \
+    if (n <= BASE_BLOCK) {                                                                    \
+        sort_block_##SUFFIX(keys, payload, n, dir);                                           \
+        return;                                                                               \
+    }                                                                                         \
+    long long half = n / 2;                                                                   \
+    _Pragma("omp task")                                                                       \
+    bitonic_sort_task_##SUFFIX(keys, payload, half, !dir);                                    \
+    _Pragma("omp task")                                                                       \
+    bitonic_sort_task_##SUFFIX(keys + half, payload ? payload + half : NULL, n - half, dir);  \
+    _Pragma("omp taskwait")                                                                   \
+    bitonic_merge_##SUFFIX(keys, payload, n, dir);                                            \
+}                                                                                             \
+                                                                                              \
+/* Entry point: sorts n keys (and the optional payload) in one parallel region */            \
+static inline void bitonic_sort_##SUFFIX(T* keys, long long* payload, long long n, int dir) { \
+    _Pragma("omp parallel")                                                                   \
+    _Pragma("omp single")                                                                     \
+    bitonic_sort_task_##SUFFIX(keys, payload, n, dir);                                        \
+}
+
+// Largest power of two strictly below n (n >= 2)
+static inline long long largest_power_of_two_below(long long n) {
+    long long m = 1;
+    while (m * 2 < n) m *= 2;
+    return m;
+}
+
+DEFINE_BITONIC_SORT(int, int32)
+DEFINE_BITONIC_SORT(long long, int64)
+DEFINE_BITONIC_SORT(float, float)
+DEFINE_BITONIC_SORT(double, double)
+
+#endif // OMP_BITONIC_SORT_H
@@ -1,83 +1,654 @@
 /*
  * Author: canetizen
  * Created on Sat May 24 2025
- * Description: OpenMP implementation for Gauss-Jordan Elimination.
+ * Description: OpenMP implementation for Gauss-Jordan Elimination (runtime size, partial pivoting, multiple right-hand sides).
  */
 
+#define _POSIX_C_SOURCE 200809L // For posix_memalign under -std=c99
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <omp.h>
 
-#define N 4  // Matrix size (NxN)
+#define N 4               // Size of the example system
+#define ALIGNMENT 64      // Every stored row starts on a cache line (also one AVX-512 vector)
+#define RESIDUAL_ROWS 256 // Rows of A read per block when the residual is checked
+#define NB 128            // Tile edge of the blocked solver: a 128 x 128 tile of doubles is 128 KB
+#define MR 8              // Rows of the register block of the update kernel
+#define PANEL_IB 16       // Columns factored at a time inside a panel
+#define NR 16             // Columns of the register block (two AVX-512 or four AVX2 vectors)
 
-// Helper function to print the augmented matrix [A | b]
-void print_matrix(double A[N][N], double b[N]) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++)
-            printf("%8.4f ", A[i][j]);
-        printf("| %8.4f\n", b[i]);
+enum { SOLVE_GAUSS_JORDAN, SOLVE_BLOCKED, SOLVE_INVERSE };
+
+const char* method_names[] = {"Gauss-Jordan", "blocked LU", "blocked LU"};
+
+// ISO C mode (-std=c99) turns off the contraction of a * b + c, so fused multiply-adds are requested explicitly where the CPU has them
+#ifdef __FMA__
+#define MADD(a, b, c) fma(a, b, c)
+#else
+#define MADD(a, b, c) ((a) * (b) + (c))
+#endif
+
+// Header of a system file, followed by A (n x n) and B (n x nrhs), row-major doubles
+typedef struct {
+    long long n;
+    long long nrhs;
+} SystemHeader;
+
+/**
+ * Augmented system [A | B] in one aligned, contiguous row-major buffer. Each
+ * row is padded to ld doubles so it stays aligned. rows[i] points at logical
+ * row i, so a pivot swap only exchanges two pointers.
+ */
+typedef struct {
+    long long n;
+    long long nrhs;
+    long long ld;
+    double* data;
+    double** rows;
+} System;
+
+// Pivot candidate: magnitude and row (the lowest row wins ties, so results do not depend on the thread count)
+typedef struct {
+    double value;
+    long long row;
+} Pivot;
+
+#pragma omp declare reduction(maxloc : Pivot : \
+    omp_out = (omp_in.value > omp_out.value || (omp_in.value == omp_out.value && omp_in.row < omp_out.row)) ? omp_in : omp_out) \
+    initializer(omp_priv = (Pivot){-1.0, -1})
+
+System alloc_system(long long n, long long nrhs) {
+    System s;
+    long long per_line = ALIGNMENT / sizeof(double);
+    s.n = n;
+    s.nrhs = nrhs;
+    s.ld = (n + nrhs + per_line - 1) / per_line * per_line;
+    void* data = NULL;
+    if (posix_memalign(&data, ALIGNMENT, (size_t)(n * s.ld * sizeof(double))) != 0) {
+        fprintf(stderr, "Error: cannot allocate a %lld x %lld system\n", n, n + nrhs);
+        exit(1);
+    }
+    s.data = (double*)data;
+    s.rows = (double**)malloc(n * sizeof(double*));
+
+    // First touch by the threads that later update the rows
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; i++) {
+        s.rows[i] = s.data + i * s.ld;
+        memset(s.rows[i], 0, s.ld * sizeof(double));
+    }
+    return s;
+}
+
+void free_system(System* s) {
+    free(s->data);
+    free(s->rows);
+}
+
+// Helper function to print the augmented matrix [A | B]
+void print_matrix(const System* s) {
+    for (long long i = 0; i < s->n; i++) {
+        for (long long j = 0; j < s->n; j++)
+            printf("%8.4f ", s->rows[i][j]);
+        printf("|");
+        for (long long c = 0; c < s->nrhs; c++)
+            printf(" %8.4f", s->rows[i][s->n + c]);
+        printf("\n");
     }
     printf("\n");
 }
 
-int main() {
-    // Augmented matrix A|b
-    double A[N][N] = {
-        {2, 1, -1, -3},
-        {-3, -1, 2, -1},
-        {-2, 1, 2, -3},
-        {1, 2, -1, -1}
-    };
+/**
+ * Gauss-Jordan elimination with partial pivoting on [A | B]. At step k every
+ * thread finds the largest |A[i][k]| among its rows i >= k, and a user-defined
+ * maxloc reduction picks the pivot row, which is swapped in by pointer. The
+ * pivot row is normalised and its multiples are subtracted from all other
+ * rows. Columns left of k are already zero in the pivot row, so updates start
+ * at column k. On return A is the identity and B holds X. Returns -1 on
+ * success or the step whose column has no nonzero pivot (singular A).
+ */
+long long gauss_jordan(System* s) {
+    long long n = s->n, cols = s->n + s->nrhs;
+    double** rows = s->rows;
 
-    double b[N] = {8, -11, -3, 4};  // Right-hand side vector
-    double x[N]; // Solution vector
+    for (long long k = 0; k < n; k++) {
+        Pivot best = {-1.0, -1};
+        #pragma omp parallel for reduction(maxloc:best)
+        for (long long i = k; i < n; i++) {
+            double v = fabs(rows[i][k]);
+            if (v > best.value) {
+                best.value = v;
+                best.row = i;
+            }
+        }
+        if (best.value == 0.0) return k;
 
-    printf("Initial Matrix:\n");
-    print_matrix(A, b);
+        double* pivot_row = rows[best.row];
+        rows[best.row] = rows[k];
+        rows[k] = pivot_row;
 
-    // Gauss-Jordan Elimination
-    // Outer loop over each pivot position (row and column index)
-    for (int k = 0; k < N; k++) {
-        // Step 1: Normalize the pivot row (row k) so that A[k][k] becomes 1
+        double inv = 1.0 / pivot_row[k];
+        #pragma omp simd aligned(pivot_row : ALIGNMENT)
+        for (long long j = k; j < cols; j++) pivot_row[j] *= inv;
+
+        // Eliminate column k from every other row
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < n; i++) {
+            double* row = rows[i];
+            double factor = row[k];
+            if (i == k || factor == 0.0) continue;
+            #pragma omp simd aligned(row, pivot_row : ALIGNMENT)
+            for (long long j = k; j < cols; j++) row[j] -= factor * pivot_row[j];
+        }
+    }
+    return -1;
+}
+
+// Floating-point operations of the elimination: (n - 1) row updates of 2 (n - k + nrhs) flops per step
+double gauss_jordan_flops(long long n, long long nrhs) {
+    return 2.0 * (n - 1) * ((double)n * (n + 1) / 2.0 + (double)n * nrhs);
+}
+
+/**
+ * C -= A * B on an MR x NR register block with depth kd. C and A are reached
+ * through row pointers plus a column offset (C[r][j] = c[r][cc + j]), B is a
+ * packed strip of kd rows of NR contiguous values. The MR x NR accumulators
+ * stay in vector registers, and every row of the strip is reused for MR
+ * broadcasts of A, like a GEMM micro-kernel.
+ */
+static inline void micro_kernel(double** c, long long cc, double** a, long long ac, const double* b, long long kd) {
+    double acc[MR][NR];
+    for (int r = 0; r < MR; r++) {
+        #pragma omp simd
+        for (int j = 0; j < NR; j++) acc[r][j] = 0.0;
+    }
+    for (long long p = 0; p < kd; p++) {
+        const double* bp = b + p * NR;
+        for (int r = 0; r < MR; r++) {
+            double ar = a[r][ac + p];
+            #pragma omp simd
+            for (int j = 0; j < NR; j++) acc[r][j] = MADD(ar, bp[j], acc[r][j]);
+        }
+    }
+    for (int r = 0; r < MR; r++) {
+        double* cr = c[r] + cc;
+        #pragma omp simd
+        for (int j = 0; j < NR; j++) cr[j] -= acc[r][j];
+    }
+}
 
-        double pivot = A[k][k];
+/**
+ * C -= A * B for an m x w block of C with depth kd. B (at most one tile) is
+ * first packed into strips of NR columns, so the micro-kernel reads it
+ * contiguously instead of touching kd rows that lie a page or more apart.
+ * packed is the calling thread's workspace of NB x NB doubles. Rows and
+ * columns that do not fill a register block use a plain SIMD loop.
+ */
+void gemm_update(double** c, long long cc, double** a, long long ac, double** b, long long bc, long long m, long long w, long long kd,
+                 double* packed) {
+    long long m_full = m - m % MR, w_full = w - w % NR;
+    for (long long j = 0; j < w_full; j += NR) {
+        for (long long p = 0; p < kd; p++) {
+            memcpy(packed + j * kd + p * NR, b[p] + bc + j, NR * sizeof(double));
+        }
+    }
 
-        // 'j' iterates over columns in row k
-        // Parallelize normalization of the pivot row
-        #pragma omp parallel for
-        for (int j = 0; j < N; j++) {
-            A[k][j] /= pivot;
+    for (long long r = 0; r < m; r += MR) {
+        if (r < m_full) {
+            for (long long j = 0; j < w_full; j += NR) micro_kernel(c + r, cc + j, a + r, ac, packed + j * kd, kd);
         }
+        // Remaining columns of these rows, or all columns of the last rows
+        long long j0 = r < m_full ? w_full : 0, r_end = r < m_full ? r + MR : m;
+        for (long long i = r; i < r_end; i++) {
+            double* ci = c[i] + cc;
+            for (long long p = 0; p < kd; p++) {
+                double aip = a[i][ac + p];
+                const double* bp = b[p] + bc;
+                #pragma omp simd
+                for (long long j = j0; j < w; j++) ci[j] -= aip * bp[j];
+            }
+        }
+    }
+}
 
-        // Normalize the corresponding value in vector b (scalar operation)
-        b[k] /= pivot;
+/**
+ * One packing workspace of NB x NB doubles per thread, allocated once per
+ * solve or residual check; thread t uses workspace + t * NB * NB.
+ */
+double* alloc_workspace(void) {
+    void* workspace = NULL;
+    if (posix_memalign(&workspace, ALIGNMENT, (size_t)omp_get_max_threads() * NB * NB * sizeof(double)) != 0) {
+        fprintf(stderr, "Error: cannot allocate the packing workspace\n");
+        exit(1);
+    }
+    return (double*)workspace;
+}
 
-        // Step 2: Eliminate all other entries in column k
-        // so that A[i][k] becomes 0 for i != k
+static inline double* thread_workspace(double* workspace) {
+    return workspace + (size_t)omp_get_thread_num() * NB * NB;
+}
+
+/**
+ * Solves the unit lower triangle L = rows[k0, k0 + kb) x columns [k0, k0 + kb)
+ * for the rows [k0, k0 + kb) of the columns [j0, j0 + w), then subtracts
+ * L_ik times that block row from every row below it.
+ */
+void eliminate_block(double** rows, long long n, long long k0, long long kb, long long j0, long long w, double* packed) {
+    for (long long r = 1; r < kb; r++) {
+        double* row = rows[k0 + r] + j0;
+        for (long long q = 0; q < r; q++) {
+            double l = rows[k0 + r][k0 + q];
+            const double* u = rows[k0 + q] + j0;
+            #pragma omp simd
+            for (long long j = 0; j < w; j++) row[j] -= l * u[j];
+        }
+    }
+    gemm_update(rows + k0 + kb, j0, rows + k0 + kb, k0, rows + k0, j0, n - k0 - kb, w, kb, packed);
+}
 
-        // 'i' iterates over rows (excluding the pivot row)
-        // Inner loop uses 'j' again to go across columns
-        #pragma omp parallel for
-        for (int i = 0; i < N; i++) {
-            if (i != k) {
-                double factor = A[i][k];  // Multiplier to eliminate A[i][k]
-                for (int j = 0; j < N; j++) {
-                    A[i][j] -= factor * A[k][j];  // Subtract scaled pivot row
+/**
+ * Panel of step k: LU with partial pivoting of rows [k0, n) x columns
+ * [k0, k0 + kb). Row swaps are applied inside the panel only and recorded in
+ * ipiv; the column tasks apply them to their own columns. The panel is
+ * itself blocked by PANEL_IB columns: a narrow strip is factored column by
+ * column while it stays in cache, and the rest of the panel is updated with
+ * eliminate_block. A zero pivot column is recorded in *singular.
+ */
+void factor_panel(double** rows, long long n, long long k0, long long kb, long long* ipiv, long long* singular, double* packed) {
+    long long k_end = k0 + kb;
+    for (long long c0 = k0; c0 < k_end; c0 += PANEL_IB) {
+        long long c_end = k_end - c0 < PANEL_IB ? k_end : c0 + PANEL_IB;
+        for (long long col = c0; col < c_end; col++) {
+            long long p = col;
+            double best = fabs(rows[col][col]);
+            for (long long i = col + 1; i < n; i++) {
+                double v = fabs(rows[i][col]);
+                if (v > best) {
+                    best = v;
+                    p = i;
+                }
+            }
+            ipiv[col] = p;
+            if (best == 0.0) {
+                #pragma omp critical(singular_column)
+                if (*singular < 0 || col < *singular) *singular = col;
+                continue;
+            }
+            if (p != col) {
+                for (long long j = k0; j < k_end; j++) {
+                    double t = rows[col][j];
+                    rows[col][j] = rows[p][j];
+                    rows[p][j] = t;
                 }
-                b[i] -= factor * b[k];  // Update corresponding value in b
+            }
+            const double* pivot_row = rows[col];
+            double inv = 1.0 / pivot_row[col];
+            for (long long i = col + 1; i < n; i++) {
+                double* row = rows[i];
+                double l = row[col] *= inv;
+                #pragma omp simd
+                for (long long j = col + 1; j < c_end; j++) row[j] -= l * pivot_row[j];
             }
         }
+        if (c_end < k_end) eliminate_block(rows, n, c0, c_end - c0, c_end, k_end - c_end, packed);
     }
+}
 
-    // Extract the final solution: since A is now identity, x = b
-    #pragma omp parallel for
-    for (int i = 0; i < N; i++)
-        x[i] = b[i];
+/**
+ * Step k on the column block [j0, j0 + w) right of the panel: apply the
+ * panel's row swaps, solve L_kk for the block row of U (or of L^-1 P B), and
+ * subtract L_ik U_kj from every block below.
+ */
+void update_column(double** rows, long long n, long long k0, long long kb, long long j0, long long w, const long long* ipiv,
+                   double* packed) {
+    for (long long col = k0; col < k0 + kb; col++) {
+        long long p = ipiv[col];
+        if (p == col) continue;
+        double* a = rows[col] + j0;
+        double* b = rows[p] + j0;
+        for (long long j = 0; j < w; j++) {
+            double t = a[j];
+            a[j] = b[j];
+            b[j] = t;
+        }
+    }
+    eliminate_block(rows, n, k0, kb, j0, w, packed);
+}
+
+// Back substitution U X = Y for the right-hand side columns [j0, j0 + w), one block row at a time from the bottom
+void back_substitute(double** rows, long long n, long long j0, long long w, double* packed) {
+    long long blocks = (n + NB - 1) / NB;
+    for (long long k = blocks - 1; k >= 0; k--) {
+        long long k0 = k * NB, kb = n - k0 < NB ? n - k0 : NB;
+        for (long long r = kb - 1; r >= 0; r--) {
+            double* row = rows[k0 + r] + j0;
+            for (long long q = r + 1; q < kb; q++) {
+                double u = rows[k0 + r][k0 + q];
+                const double* x = rows[k0 + q] + j0;
+                #pragma omp simd
+                for (long long j = 0; j < w; j++) row[j] -= u * x[j];
+            }
+            double inv = 1.0 / rows[k0 + r][k0 + r];
+            #pragma omp simd
+            for (long long j = 0; j < w; j++) row[j] *= inv;
+        }
+        gemm_update(rows, j0, rows, k0, rows + k0, j0, k0, w, kb, packed);
+    }
+}
+
+/**
+ * Blocked LU with partial pivoting as an OpenMP task DAG on [A | B], followed
+ * by back substitution, so B is overwritten by X. The columns are cut into
+ * blocks of NB (A and B separately). Step k has one panel task and one update
+ * task per column block right of it. Tasks depend on one token per column
+ * block, so the panel of step k + 1 starts as soon as its own column has been
+ * updated by step k, while the other updates of step k are still running.
+ * The forward substitution with B is part of the same updates (B is just
+ * more columns), so the rows of L left of the panel never need swapping. The
+ * back substitution runs one task per block of right-hand sides. Tasks are
+ * tied and never suspend, so each uses the packing workspace of the thread
+ * running it. Returns -1 on success or the first column without a nonzero pivot.
+ */
+long long blocked_lu_solve(System* s) {
+    long long n = s->n, nrhs = s->nrhs;
+    long long a_blocks = (n + NB - 1) / NB, blocks = a_blocks + (nrhs + NB - 1) / NB;
+    double** rows = s->rows;
+    long long* ipiv = (long long*)malloc(n * sizeof(long long));
+    char* column = (char*)malloc(blocks);  // Dependency tokens, one per column block
+    double* workspace = alloc_workspace();
+    long long singular = -1;
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        for (long long k = 0; k < a_blocks; k++) {
+            long long k0 = k * NB, kb = n - k0 < NB ? n - k0 : NB;
+            #pragma omp task depend(inout: column[k]) priority(2) shared(singular)
+            factor_panel(rows, n, k0, kb, ipiv, &singular, thread_workspace(workspace));
+
+            for (long long j = k + 1; j < blocks; j++) {
+                long long j0 = j < a_blocks ? j * NB : n + (j - a_blocks) * NB;
+                long long limit = j < a_blocks ? n : n + nrhs;
+                long long w = limit - j0 < NB ? limit - j0 : NB;
+                // The next panel's column goes first: it is on the critical path
+                #pragma omp task depend(in: column[k]) depend(inout: column[j]) priority(j == k + 1 ? 1 : 0)
+                update_column(rows, n, k0, kb, j0, w, ipiv, thread_workspace(workspace));
+            }
+        }
+        #pragma omp taskwait
+
+        if (singular < 0) {
+            for (long long j0 = n; j0 < n + nrhs; j0 += NB) {
+                long long w = n + nrhs - j0 < NB ? n + nrhs - j0 : NB;
+                #pragma omp task
+                back_substitute(rows, n, j0, w, thread_workspace(workspace));
+            }
+        }
+    }
+    free(ipiv);
+    free(column);
+    free(workspace);
+    return singular;
+}
+
+// Floating-point operations of LU with partial pivoting plus the two triangular solves
+double lu_solve_flops(long long n, long long nrhs) {
+    return 2.0 * n * n * (double)n / 3.0 + 2.0 * (double)n * n * nrhs;
+}
+
+// Uniform [-1, 1) value from a SplitMix64 hash of a global element index
+double random_entry(unsigned long long i) {
+    unsigned long long z = i * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (z >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+// Writes a random n x n system with nrhs right-hand sides
+void generate_file(const char* path, long long n, long long nrhs) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        exit(1);
+    }
+    SystemHeader header = {n, nrhs};
+    fwrite(&header, sizeof(header), 1, f);
+
+    double* row = (double*)malloc((n > nrhs ? n : nrhs) * sizeof(double));
+    for (long long part = 0; part < 2; part++) {
+        long long width = part == 0 ? n : nrhs;
+        unsigned long long base = part == 0 ? 0 : (unsigned long long)n * n;
+        for (long long i = 0; i < n; i++) {
+            #pragma omp parallel for simd
+            for (long long j = 0; j < width; j++) row[j] = random_entry(base + (unsigned long long)(i * width + j));
+            fwrite(row, sizeof(double), width, f);
+        }
+    }
+    free(row);
+    fclose(f);
+    printf("Wrote a %lld x %lld system with %lld right-hand sides to %s\n", n, n, nrhs, path);
+}
+
+// Reads [A | B] from a system file; with inverse set, B is replaced by the n x n identity
+System read_system(const char* path, int inverse) {
+    FILE* f = fopen(path, "rb");
+    SystemHeader header;
+    if (!f || fread(&header, sizeof(header), 1, f) != 1 || header.n < 1 || header.nrhs < 1) {
+        fprintf(stderr, "Error: cannot read a system from %s\n", path);
+        exit(1);
+    }
+    System s = alloc_system(header.n, inverse ? header.n : header.nrhs);
+    long long ok = 1;
+    for (long long i = 0; i < s.n; i++) ok &= fread(s.rows[i], sizeof(double), s.n, f) == (size_t)s.n;
+    for (long long i = 0; i < s.n; i++) {
+        if (inverse) {
+            s.rows[i][s.n + i] = 1.0;
+        } else {
+            ok &= fread(s.rows[i] + s.n, sizeof(double), s.nrhs, f) == (size_t)s.nrhs;
+        }
+    }
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "Error: %s is shorter than its header says\n", path);
+        exit(1);
+    }
+    return s;
+}
+
+/**
+ * Residual of the solution against the original system. A and B are streamed
+ * again from the file in blocks of rows, and X is read in place from the
+ * solved system, so no second copy of a matrix is kept in memory. B is the
+ * identity when X is an inverse. Returns ||AX - B||inf and sets *relative to
+ * ||AX - B||inf / (||A||inf ||X||inf + ||B||inf).
+ */
+double residual_from_file(const char* path, const System* s, int inverse, double* relative) {
+    long long n = s->n, nrhs = s->nrhs;
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Error: cannot reopen %s\n", path);
+        exit(1);
+    }
+    double* block = (double*)malloc(RESIDUAL_ROWS * n * sizeof(double));
+    double* r = (double*)malloc(RESIDUAL_ROWS * nrhs * sizeof(double));
+    double** a_rows = (double**)malloc(RESIDUAL_ROWS * sizeof(double*));
+    double** r_rows = (double**)malloc(RESIDUAL_ROWS * sizeof(double*));
+    double** x_rows = (double**)malloc(n * sizeof(double*));
+    double* workspace = alloc_workspace();
+    double norm_x = 0.0, norm_b = 0.0, norm_a = 0.0, norm_r = 0.0;
+
+    // X is the right part of the solved system
+    #pragma omp parallel for reduction(max:norm_x)
+    for (long long i = 0; i < n; i++) {
+        double sum = 0.0;
+        x_rows[i] = s->rows[i] + n;
+        for (long long c = 0; c < nrhs; c++) sum += fabs(x_rows[i][c]);
+        if (sum > norm_x) norm_x = sum;
+    }
+
+    size_t got = 0;
+    for (long long first = 0; first < n; first += RESIDUAL_ROWS) {
+        long long count = n - first < RESIDUAL_ROWS ? n - first : RESIDUAL_ROWS;
+        fseek(f, (long)(sizeof(SystemHeader) + first * n * sizeof(double)), SEEK_SET);
+        got += fread(block, sizeof(double), count * n, f);
+        if (!inverse) {
+            fseek(f, (long)(sizeof(SystemHeader) + (n * n + first * nrhs) * sizeof(double)), SEEK_SET);
+            got += fread(r, sizeof(double), count * nrhs, f);
+        }
+
+        // R = B - A X for this block of rows, with the update kernel of the blocked solver
+        #pragma omp parallel for schedule(static) reduction(max:norm_b)
+        for (long long i = 0; i < count; i++) {
+            double row_b = 0.0;
+            a_rows[i] = block + i * n;
+            r_rows[i] = r + i * nrhs;
+            for (long long c = 0; c < nrhs; c++) {
+                if (inverse) r_rows[i][c] = (double)(c == first + i);
+                row_b += fabs(r_rows[i][c]);
+            }
+            if (row_b > norm_b) norm_b = row_b;
+        }
+        long long col_chunks = (nrhs + NB - 1) / NB, row_groups = (count + MR * 8 - 1) / (MR * 8);
+        #pragma omp parallel for schedule(dynamic)
+        for (long long t = 0; t < col_chunks * row_groups; t++) {
+            long long c0 = t % col_chunks * NB, r0 = t / col_chunks * MR * 8;
+            long long w = nrhs - c0 < NB ? nrhs - c0 : NB, m = count - r0 < MR * 8 ? count - r0 : MR * 8;
+            for (long long p0 = 0; p0 < n; p0 += NB) {
+                gemm_update(r_rows + r0, c0, a_rows + r0, p0, x_rows + p0, c0, m, w, n - p0 < NB ? n - p0 : NB,
+                            thread_workspace(workspace));
+            }
+        }
+
+        #pragma omp parallel for reduction(max:norm_a, norm_r)
+        for (long long i = 0; i < count; i++) {
+            double row_a = 0.0, row_r = 0.0;
+            for (long long j = 0; j < n; j++) row_a += fabs(a_rows[i][j]);
+            for (long long c = 0; c < nrhs; c++) row_r += fabs(r_rows[i][c]);
+            if (row_a > norm_a) norm_a = row_a;
+            if (row_r > norm_r) norm_r = row_r;
+        }
+    }
+    fclose(f);
+    if (got != (size_t)((inverse ? 0 : n * nrhs) + n * n)) {
+        fprintf(stderr, "Error: cannot reread the system from %s\n", path);
+        exit(1);
+    }
+    free(block);
+    free(r);
+    free(a_rows);
+    free(r_rows);
+    free(x_rows);
+    free(workspace);
+    *relative = norm_r / (norm_a * norm_x + norm_b);
+    return norm_r;
+}
+
+// Writes X (n x nrhs, row-major doubles; the inverse is n x n)
+void write_solution(const char* path, const System* s) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open %s for writing\n", path);
+        exit(1);
+    }
+    for (long long i = 0; i < s->n; i++) fwrite(s->rows[i] + s->n, sizeof(double), s->nrhs, f);
+    fclose(f);
+}
+
+/**
+ * File mode: solve the system in path with the chosen method, report GFLOP/s
+ * and the residual, and optionally write X. SOLVE_INVERSE ignores B and
+ * computes X = A^-1 with the blocked solver.
+ */
+void solve_file(const char* path, const char* out_path, int method) {
+    double start = omp_get_wtime();
+    System s = read_system(path, method == SOLVE_INVERSE);
+    double t_read = omp_get_wtime();
+    long long failed = method == SOLVE_GAUSS_JORDAN ? gauss_jordan(&s) : blocked_lu_solve(&s);
+    double t_solve = omp_get_wtime();
+    if (failed >= 0) {
+        fprintf(stderr, "Error: the matrix is singular (no nonzero pivot in column %lld)\n", failed);
+        exit(1);
+    }
+
+    double relative;
+    double residual = residual_from_file(path, &s, method == SOLVE_INVERSE, &relative);
+    double t_check = omp_get_wtime();
+    if (out_path) write_solution(out_path, &s);
+
+    double flops = method == SOLVE_GAUSS_JORDAN ? gauss_jordan_flops(s.n, s.nrhs) : lu_solve_flops(s.n, s.nrhs);
+    if (method == SOLVE_INVERSE) {
+        printf("Inverted a %lld x %lld matrix (%s) using %d threads\n", s.n, s.n, method_names[method], omp_get_max_threads());
+    } else {
+        printf("Solved a %lld x %lld system with %lld right-hand sides (%s) using %d threads\n",
+               s.n, s.n, s.nrhs, method_names[method], omp_get_max_threads());
+    }
+    printf("Read: %.3f s | solve: %.3f s (%.2f GFLOP/s) | residual check: %.3f s\n",
+           t_read - start, t_solve - t_read, flops / (t_solve - t_read) / 1e9, t_check - t_solve);
+    printf("||AX - %s||inf = %.3e, relative residual = %.3e\n", method == SOLVE_INVERSE ? "I" : "B", residual, relative);
+    printf("Execution time: %.6f seconds\n", t_solve - t_read);
+    free_system(&s);
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s\n", prog);
+    printf("       %s -g <file> <n> [nrhs]\n", prog);
+    printf("       %s -f <file> [solution_out]\n", prog);
+    printf("       %s -b <file> [solution_out]\n", prog);
+    printf("       %s -i <file> [inverse_out]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "-g") == 0) {
+        long long n = atoll(argv[3]), nrhs = argc == 5 ? atoll(argv[4]) : 1;
+        if (n < 1 || nrhs < 1) {
+            printf("Error: n and nrhs must be positive.\n");
+            return 1;
+        }
+        generate_file(argv[2], n, nrhs);
+        return 0;
+    }
+    if ((argc == 3 || argc == 4) && (strcmp(argv[1], "-f") == 0 || strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "-i") == 0)) {
+        int method = argv[1][1] == 'f' ? SOLVE_GAUSS_JORDAN : argv[1][1] == 'b' ? SOLVE_BLOCKED : SOLVE_INVERSE;
+        solve_file(argv[2], argc == 4 ? argv[3] : NULL, method);
+        return 0;
+    }
+    if (argc != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Augmented matrix A|b
+    double A[N][N] = {
+        {2, 1, -1, -3},
+        {-3, -1, 2, -1},
+        {-2, 1, 2, -3},
+        {1, 2, -1, -1}
+    };
+    double b[N] = {8, -11, -3, 4};  // Right-hand side vector
+
+    System s = alloc_system(N, 1);
+    for (int i = 0; i < N; i++) {
+        memcpy(s.rows[i], A[i], N * sizeof(double));
+        s.rows[i][N] = b[i];
+    }
+
+    printf("Initial Matrix:\n");
+    print_matrix(&s);
+
+    if (gauss_jordan(&s) >= 0) {
+        printf("Error: the matrix is singular\n");
+        return 1;
+    }
 
-    // Output the solution vector
+    // A is now the identity, so the solution is the last column
     printf("Solution vector (x):\n");
     for (int i = 0; i < N; i++)
-        printf("x[%d] = %8.4f\n", i, x[i]);
+        printf("x[%d] = %8.4f\n", i, s.rows[i][N]);
 
+    free_system(&s);
     return 0;
 }
@@ -1,17 +1,119 @@
 /*
  * Author: canetizen
  * Created on Sat May 24 2025
- * Description: OpenMP implementation for parallel pi estimation.
+ * Description: OpenMP implementation for parallel pi estimation (midpoint rule and Monte Carlo with Philox streams).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <omp.h>
 
+// Philox4x32-10 constants (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+#define PHILOX_LANES 64 // Philox blocks generated side by side in SIMD lanes per chunk
+
+// One 128-bit Philox output block
+typedef struct {
+    unsigned int word[4];
+} PhiloxBlock;
+
+/**
+ * Philox4x32-10: a counter-based generator. The four output words depend
+ * only on the 128-bit counter and the 64-bit key, so sample i always gets
+ * the same numbers whichever thread or SIMD lane draws it. There is no
+ * state to carry between calls, so a loop over counters vectorises across
+ * lanes (32 x 32 -> 64-bit multiplies).
+ */
+static inline PhiloxBlock philox4x32(unsigned int c0, unsigned int c1, unsigned int c2, unsigned int c3,
+                                     unsigned int key0, unsigned int key1) {
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        unsigned long long p0 = (unsigned long long)PHILOX_M0 * c0;
+        unsigned long long p1 = (unsigned long long)PHILOX_M1 * c2;
+        c0 = (unsigned int)(p1 >> 32) ^ c1 ^ key0;
+        c1 = (unsigned int)p1;
+        c2 = (unsigned int)(p0 >> 32) ^ c3 ^ key1;
+        c3 = (unsigned int)p0;
+        key0 += PHILOX_W0;
+        key1 += PHILOX_W1;
+    }
+    PhiloxBlock out = {{c0, c1, c2, c3}};
+    return out;
+}
+
+// Point (u, v) of the unit square, from two 32-bit words at the centre of their cell, lies inside the quarter circle
+static inline unsigned int inside(unsigned int u, unsigned int v) {
+    double x = (u + 0.5) * (1.0 / 4294967296.0), y = (v + 0.5) * (1.0 / 4294967296.0);
+    return x * x + y * y < 1.0;
+}
+
+/**
+ * Monte Carlo pi: sample i is the point drawn from half of the Philox block
+ * with counter i / 2. Threads split chunks of PHILOX_LANES consecutive
+ * blocks, and the SIMD lanes of a chunk run Philox side by side. The hit
+ * count is an integer sum, so the estimate is bit-identical for any number
+ * of threads.
+ */
+unsigned long long monte_carlo_hits(unsigned long long samples, unsigned long long seed) {
+    unsigned long long blocks = samples / 2 + samples % 2, chunks = blocks / PHILOX_LANES, hits = 0;
+    unsigned int key0 = (unsigned int)seed, key1 = (unsigned int)(seed >> 32);
+
+    #pragma omp parallel for reduction(+:hits) schedule(static)
+    for (unsigned long long chunk = 0; chunk < chunks; chunk++) {
+        // PHILOX_LANES divides 2^32, so the low counter word of a chunk never carries into the high one
+        unsigned int low = (unsigned int)(chunk * PHILOX_LANES), high = (unsigned int)(chunk * PHILOX_LANES >> 32);
+        unsigned int chunk_hits = 0;
+        #pragma omp simd reduction(+:chunk_hits)
+        for (unsigned int lane = 0; lane < PHILOX_LANES; lane++) {
+            PhiloxBlock r = philox4x32(low + lane, high, 0, 0, key0, key1);
+            chunk_hits += inside(r.word[0], r.word[1]) + inside(r.word[2], r.word[3]);
+        }
+        hits += chunk_hits;
+    }
+
+    // Remaining blocks; the second point of the last block is unused when samples is odd
+    for (unsigned long long i = chunks * PHILOX_LANES; i < blocks; i++) {
+        PhiloxBlock r = philox4x32((unsigned int)i, (unsigned int)(i >> 32), 0, 0, key0, key1);
+        hits += inside(r.word[0], r.word[1]) + (2 * i + 1 < samples ? inside(r.word[2], r.word[3]) : 0);
+    }
+    return hits;
+}
+
+void run_monte_carlo(unsigned long long samples, unsigned long long seed) {
+    double start = omp_get_wtime();
+    unsigned long long hits = monte_carlo_hits(samples, seed);
+    double elapsed = omp_get_wtime() - start;
+
+    // Each sample is a Bernoulli trial with p = pi / 4, so the standard error of 4 * hits / samples is 4 sqrt(p (1 - p) / samples)
+    double p = (double)hits / samples;
+    double pi = 4.0 * p;
+    printf("Monte Carlo estimate of pi: %.15f (%llu of %llu samples inside, seed %llu)\n", pi, hits, samples, seed);
+    printf("Standard error: %.3e | actual error: %.3e\n", 4.0 * sqrt(p * (1.0 - p) / samples), fabs(pi - 3.14159265358979323846));
+    printf("Throughput: %.3e samples/s with %d threads\n", samples / elapsed, omp_get_max_threads());
+    printf("Execution time: %.6f seconds\n", elapsed);
+}
+
 int main(int argc, char *argv[]) {
+    // Monte Carlo mode: -m <num_samples> [seed]
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "-m") == 0) {
+        long long samples = atoll(argv[2]);
+        if (samples <= 0) {
+            printf("Error: num_samples must be a positive integer.\n");
+            return 1;
+        }
+        run_monte_carlo((unsigned long long)samples, argc == 4 ? strtoull(argv[3], NULL, 10) : 1);
+        return 0;
+    }
+
     // Check if user provided the number of steps
     if (argc != 2) {
         printf("Usage: %s <num_steps>\n", argv[0]);
+        printf("       %s -m <num_samples> [seed]\n", argv[0]);
         return 1;
     }
 
@@ -24,6 +126,7 @@ int main(int argc, char *argv[]) {
 
     double step, pi, sum = 0.0;
     step = 1.0 / (double) num_steps;
+    double start = omp_get_wtime();
 
     // Start of parallel region
     #pragma omp parallel
@@ -32,7 +135,7 @@ int main(int argc, char *argv[]) {
 
         // Each thread computes a portion of the sum
         #pragma omp for reduction(+:sum)
-        for (int i = 0; i < num_steps; i++) {
+        for (long i = 0; i < num_steps; i++) {
             x = (i + 0.5) * step;                  // Midpoint of interval
             sum += 4.0 / (1.0 + x * x);            // Add to local sum
         }
@@ -41,6 +144,7 @@ int main(int argc, char *argv[]) {
     // Final result
     pi = step * sum;
     printf("Approximate value of pi: %.15f\n", pi);
+    printf("Execution time: %.6f seconds\n", omp_get_wtime() - start);
 
     return 0;
 }
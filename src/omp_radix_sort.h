@@ -0,0 +1,189 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: Parallel LSD radix sort for int32, int64, float and double keys, shared by omp_radix_sort and omp_sort_benchmark.
+ */
+
+#ifndef OMP_RADIX_SORT_H
+#define OMP_RADIX_SORT_H
+
+// Every program is built from one source file, so the sorts are defined here rather than in a library.
+// Everything is static, so several translation units of one program can include this header.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <omp.h>
+
+#define RADIX_SMALL 64             // Shorter inputs are insertion sorted
+#define RADIX_MIN_PER_THREAD 65536 // Keys per thread below which fewer threads are used
+#define WC_BYTES 256               // Write-combining buffer per bucket: four cache lines
+
+/*
+ * Order-preserving maps between keys and their unsigned bit patterns. Signed
+ * integers flip the sign bit. Floats flip every bit of negative values (their
+ * magnitude order is reversed) and only the sign bit of positive ones.
+ */
+#define INT_TO_BITS(u, SIGN) ((u) ^ (SIGN))
+#define INT_FROM_BITS(u, SIGN) ((u) ^ (SIGN))
+#define FLOAT_TO_BITS(u, SIGN) (((u) & (SIGN)) ? ~(u) : ((u) | (SIGN)))
+#define FLOAT_FROM_BITS(u, SIGN) (((u) & (SIGN)) ? ((u) ^ (SIGN)) : ~(u))
+
+/**
+ * LSD radix sort of unsigned keys, generated per key width. Every pass
+ * handles digit_bits bits (8 or 11):
+ *   1. each thread counts the digits of its contiguous slice of the keys;
+ *   2. a prefix sum over (bucket, thread) gives every thread its own output
+ *      offset in every bucket, so the scatter is stable and needs no atomics;
+ *   3. each thread scatters its slice through per-bucket write-combining
+ *      buffers of WC_BYTES. A key lands in the buffer slot given by its output
+ *      address modulo WC_BYTES, so a buffer fills up exactly when its output
+ *      reaches a WC_BYTES boundary. The first flush of a bucket writes the
+ *      head fragment up to that boundary; every later full flush is one
+ *      aligned copy of whole cache lines.
+ * The buffers (64 KB for 256 buckets, 512 KB for 2048) stay in L1/L2, and
+ * each output page is touched once per flush rather than once per key. With
+ * one-line buffers, 2^24 int32 keys sort about 1.7x slower. Passes where
+ * every key has the same digit (sorted prefixes, few distinct values) are
+ * skipped. tmp must hold n keys, and the result ends up in keys.
+ *
+ * Generated name: radix_sort_bits_X.
+ */
+#define DEFINE_RADIX_CORE(U, USUFFIX)                                                          \
+static inline void radix_sort_bits_##USUFFIX(U* keys, U* tmp, long long n, int digit_bits) {  \
+    if (n < RADIX_SMALL) {                                                                    \
+        for (long long i = 1; i < n; i++) {                                                   \
+            U v = keys[i];                                                                    \
+            long long j = i - 1;                                                              \
+            while (j >= 0 && keys[j] > v) {                                                   \
+                keys[j + 1] = keys[j];                                                        \
+                j--;                                                                          \
+            }                                                                                 \
+            keys[j + 1] = v;                                                                  \
+        }                                                                                     \
+        return;                                                                               \
+    }                                                                                         \
+    const int key_bits = 8 * (int)sizeof(U), buckets = 1 << digit_bits;                       \
+    const int line = WC_BYTES / (int)sizeof(U);                                               \
+    const U mask = (U)(buckets - 1);                                                          \
+    int threads = omp_get_max_threads();                                                      \
+    if (n / RADIX_MIN_PER_THREAD < threads) threads = (int)(n / RADIX_MIN_PER_THREAD);        \
+    if (threads < 1) threads = 1;                                                             \
+    long long* hist = (long long*)malloc((size_t)threads * buckets * sizeof(long long));      \
+    U* result = keys;                                                                         \
+                                                                                              \
+    _Pragma("omp parallel num_threads(threads)")                                              \
+    {                                                                                         \
+        int t = omp_get_thread_num();                                                         \
+        long long lo = n * t / threads, hi = n * (t + 1) / threads;                           \
+        long long* count = hist + (size_t)t * buckets;                                        \
+        long long* offset = (long long*)malloc(buckets * sizeof(long long));                  \
+        int* fill = (int*)malloc(buckets * sizeof(int));                                      \
+        int* head = (int*)malloc(buckets * sizeof(int));                                      \
+        char* wc_raw = (char*)malloc((size_t)(buckets + 1) * WC_BYTES);                       \
+        U* wc = (U*)(((uintptr_t)wc_raw + WC_BYTES - 1) & ~(uintptr_t)(WC_BYTES - 1));        \
+        U* src = keys;                                                                        \
+        U* dst = tmp;                                                                         \
+                                                                                              \
+        for (int shift = 0; shift < key_bits; shift += digit_bits) {                          \
+            memset(count, 0, buckets * sizeof(long long));                                    \
+            for (long long i = lo; i < hi; i++) count[(src[i] >> shift) & mask]++;            \
+            _Pragma("omp barrier")                                                            \
+                                                                                              \
+            /* Bucket b of thread t starts after all smaller buckets and after          */    \
+            /* bucket b of the threads before t                                         */    \
+            long long base = 0;                                                               \
+            int skip = 0;                                                                     \
+            for (int b = 0; b < buckets; b++) {                                               \
+                long long total = 0;                                                          \
+                for (int u = 0; u < threads; u++) {                                           \
+                    if (u == t) offset[b] = base + total;                                     \
+                    total += hist[(size_t)u * buckets + b];                                   \
+                }                                                                             \
+                if (total == n) skip = 1;                                                     \
+                base += total;                                                                \
+            }                                                                                 \
+            _Pragma("omp barrier")                                                            \
+            if (skip) continue;                                                               \
+                                                                                              \
+            /* Slots before head[b] belong to the previous bucket's part of the line    */    \
+            const long long phase = (long long)((uintptr_t)dst % WC_BYTES / sizeof(U));       \
+            for (int b = 0; b < buckets; b++) {                                               \
+                fill[b] = head[b] = (int)((offset[b] + phase) % line);                        \
+            }                                                                                 \
+            for (long long i = lo; i < hi; i++) {                                             \
+                U k = src[i];                                                                 \
+                int b = (int)((k >> shift) & mask);                                           \
+                U* buffer = wc + (size_t)b * line;                                            \
+                buffer[fill[b]++] = k;                                                        \
+                if (fill[b] == line) {                                                        \
+                    if (head[b] == 0) {                                                       \
+                        memcpy(dst + offset[b], buffer, WC_BYTES);                            \
+                    } else {                                                                  \
+                        memcpy(dst + offset[b], buffer + head[b], (line - head[b]) * sizeof(U)); \
+                    }                                                                         \
+                    offset[b] += line - head[b];                                              \
+                    fill[b] = head[b] = 0;                                                    \
+                }                                                                             \
+            }                                                                                 \
+            for (int b = 0; b < buckets; b++) {                                               \
+                memcpy(dst + offset[b], wc + (size_t)b * line + head[b], (fill[b] - head[b]) * sizeof(U)); \
+            }                                                                                 \
+            U* swap = src;                                                                    \
+            src = dst;                                                                        \
+            dst = swap;                                                                       \
+            _Pragma("omp barrier")                                                            \
+        }                                                                                     \
+        if (t == 0) result = src;                                                             \
+        free(offset);                                                                         \
+        free(fill);                                                                           \
+        free(head);                                                                           \
+        free(wc_raw);                                                                         \
+    }                                                                                         \
+                                                                                              \
+    if (result != keys) {                                                                     \
+        _Pragma("omp parallel for simd num_threads(threads)")                                 \
+        for (long long i = 0; i < n; i++) keys[i] = result[i];                                \
+    }                                                                                         \
+    free(hist);                                                                               \
+}
+
+DEFINE_RADIX_CORE(unsigned int, u32)
+DEFINE_RADIX_CORE(unsigned long long, u64)
+
+/**
+ * Typed entry points radix_sort_X(keys, n, digit_bits): the keys are mapped
+ * in place to order-preserving unsigned bit patterns, sorted as unsigned
+ * integers and mapped back. memcpy does the type punning, so the maps are
+ * also valid for float and double under strict aliasing. Ascending order;
+ * -0.0 sorts before 0.0, and NaNs go to the end (positive sign) or to the
+ * front (negative sign).
+ */
+#define DEFINE_RADIX_SORT(T, U, USUFFIX, SUFFIX, TO_BITS, FROM_BITS, SIGN)                    \
+static inline void radix_sort_##SUFFIX(T* keys, long long n, int digit_bits) {                \
+    U* bits = (U*)keys;                                                                       \
+    U* tmp = (U*)malloc((n > 0 ? n : 1) * sizeof(U));                                         \
+    _Pragma("omp parallel for")                                                               \
+    for (long long i = 0; i < n; i++) {                                                       \
+        U u;                                                                                  \
+        memcpy(&u, keys + i, sizeof(U));                                                      \
+        u = TO_BITS(u, SIGN);                                                                 \
+        memcpy(bits + i, &u, sizeof(U));                                                      \
+    }                                                                                         \
+    radix_sort_bits_##USUFFIX(bits, tmp, n, digit_bits);                                      \
+    _Pragma("omp parallel for")                                                               \
+    for (long long i = 0; i < n; i++) {                                                       \
+        U u;                                                                                  \
+        memcpy(&u, bits + i, sizeof(U));                                                      \
+        u = FROM_BITS(u, SIGN);                                                               \
+        memcpy(keys + i, &u, sizeof(U));                                                      \
+    }                                                                                         \
+    free(tmp);                                                                                \
+}
+
+DEFINE_RADIX_SORT(int, unsigned int, u32, int32, INT_TO_BITS, INT_FROM_BITS, 0x80000000U)
+DEFINE_RADIX_SORT(long long, unsigned long long, u64, int64, INT_TO_BITS, INT_FROM_BITS, 0x8000000000000000ULL)
+DEFINE_RADIX_SORT(float, unsigned int, u32, float, FLOAT_TO_BITS, FLOAT_FROM_BITS, 0x80000000U)
+DEFINE_RADIX_SORT(double, unsigned long long, u64, double, FLOAT_TO_BITS, FLOAT_FROM_BITS, 0x8000000000000000ULL)
+
+#endif // OMP_RADIX_SORT_H
@@ -0,0 +1,136 @@
+/*
+ * Author: canetizen
+ * Created on Sun Oct 18 2026
+ * Description: OpenMP sorting benchmark comparing bitonic sort, radix sort and qsort over input distributions, sizes and thread counts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "omp_bitonic_sort.h"
+#include "omp_radix_sort.h"
+
+enum { DIST_UNIFORM, DIST_SORTED, DIST_REVERSE, DIST_FEW_UNIQUE };
+
+const char* dist_names[] = {"uniform", "sorted", "reverse", "few-unique"};
+const char* algo_names[] = {"bitonic", "radix8", "radix11"};
+
+#define FEW_UNIQUE_KEYS 16
+
+// SplitMix64 of the index: inputs are reproducible and generated in parallel
+unsigned long long key_hash(unsigned long long i) {
+    unsigned long long z = i * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void fill_input(int* keys, long long n, int dist) {
+    #pragma omp parallel for
+    for (long long i = 0; i < n; i++) {
+        int r = (int)(key_hash(i) >> 32);
+        switch (dist) {
+            case DIST_SORTED: keys[i] = (int)(i - n / 2); break;
+            case DIST_REVERSE: keys[i] = (int)(n / 2 - i); break;
+            case DIST_FEW_UNIQUE: keys[i] = (r & (FEW_UNIQUE_KEYS - 1)) * 1000003; break;
+            default: keys[i] = r; break;
+        }
+    }
+}
+
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts one copy of the input with the given algorithm (0 bitonic, 1 radix
+ * 8-bit, 2 radix 11-bit) and checks it against the qsort result.
+ */
+double time_sort(int algo, int* keys, const int* expected, long long n, int dist) {
+    fill_input(keys, n, dist);
+
+    double start = omp_get_wtime();
+    if (algo == 0) {
+        bitonic_sort_int32(keys, NULL, n, 1);
+    } else {
+        radix_sort_int32(keys, n, algo == 1 ? 8 : 11);
+    }
+    double elapsed = omp_get_wtime() - start;
+
+    if (memcmp(keys, expected, n * sizeof(int)) != 0) {
+        printf("Error: %s result differs from qsort (%s, n = %lld)\n", algo_names[algo], dist_names[dist], n);
+        exit(1);
+    }
+    return elapsed;
+}
+
+/**
+ * Every distribution and size 2^min_log .. 2^max_log (step log_step) is
+ * sorted with qsort once, then with bitonic sort and both radix widths at
+ * 1, 2, 4, ... and all available threads. Times are in seconds; the last
+ * column is the fastest parallel sort and its speedup over qsort. The
+ * reported execution time is that of all parallel sorts at the full thread count.
+ */
+void run_sort_benchmark(int min_log, int max_log, int log_step) {
+    int max_threads = omp_get_max_threads();
+    long long max_n = 1LL << max_log;
+    int* keys = (int*)malloc(max_n * sizeof(int));
+    int* expected = (int*)malloc(max_n * sizeof(int));
+    double total = 0.0;
+
+    printf("int32 keys, up to %d threads (times in seconds)\n", max_threads);
+    printf("%-10s %-6s %-7s %-9s %-9s %-9s %-9s %s\n", "input", "log2_n", "threads", "qsort", "bitonic", "radix8", "radix11", "best");
+    for (int dist = 0; dist < 4; dist++) {
+        for (int log_n = min_log; log_n <= max_log; log_n += log_step) {
+            long long n = 1LL << log_n;
+            fill_input(expected, n, dist);
+            double start = omp_get_wtime();
+            qsort(expected, n, sizeof(int), compare_ints);
+            double t_qsort = omp_get_wtime() - start;
+
+            for (int threads = 1; threads <= max_threads; threads = (threads * 2 > max_threads && threads < max_threads) ? max_threads : threads * 2) {
+                double t[3];
+                int best = 0;
+                omp_set_num_threads(threads);
+                for (int algo = 0; algo < 3; algo++) {
+                    t[algo] = time_sort(algo, keys, expected, n, dist);
+                    if (t[algo] < t[best]) best = algo;
+                    if (threads == max_threads) total += t[algo];
+                }
+                printf("%-10s %-6d %-7d %-9.4f %-9.4f %-9.4f %-9.4f %s %.1fx\n", dist_names[dist], log_n, threads,
+                       t_qsort, t[0], t[1], t[2], algo_names[best], t_qsort / t[best]);
+            }
+            omp_set_num_threads(max_threads);
+        }
+    }
+    printf("Execution time: %.6f seconds\n", total);
+
+    free(keys);
+    free(expected);
+}
+
+void print_usage(const char* prog) {
+    printf("Usage: %s [min_log2_n] [max_log2_n] [log2_step]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    simd_width = detect_simd_width();
+
+    if (argc > 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    int min_log = argc > 1 ? atoi(argv[1]) : 16;
+    int max_log = argc > 2 ? atoi(argv[2]) : 28;
+    int log_step = argc > 3 ? atoi(argv[3]) : 4;
+    if (min_log < 1 || max_log > 30 || min_log > max_log || log_step < 1) {
+        printf("Error: need 1 <= min_log2_n <= max_log2_n <= 30 and log2_step >= 1.\n");
+        return 1;
+    }
+
+    run_sort_benchmark(min_log, max_log, log_step);
+    return 0;
+}